@@ -0,0 +1,150 @@
+                section         .text
+
+; long arithmetic as System V AMD64 functions, to be linked with C and C++ code
+; (see long_arith.h). The loops follow those of add.asm, sub.asm and mul.asm
+; but are written anew: they take separate result and operand arrays and return
+; carries, while the programs work in place and keep every register. Long
+; numbers are arrays of qwords, least significant first; lengths are in qwords
+; and must be positive. Only rax, rcx, rdx, rsi, rdi and r8-r11 are changed,
+; rbx is saved
+
+                global          add_long_long
+                global          sub_long_long
+                global          mul_long_short
+                global          mul_long_long
+                global          div_long_short
+
+; adds two long numbers
+;    rdi -- address of sum (long number), may be one of the summands
+;    rsi -- address of summand #1 (long number)
+;    rdx -- address of summand #2 (long number)
+;    rcx -- length of long numbers in qwords
+; result:
+;    rax -- carry out of the top qword
+add_long_long:
+                xor             eax, eax
+.loop:
+                mov             r8, [rsi + rax * 8]
+                adc             r8, [rdx + rax * 8]
+                mov             [rdi + rax * 8], r8
+                lea             rax, [rax + 1]
+                dec             rcx
+                jnz             .loop
+
+                mov             eax, 0
+                adc             eax, 0
+                ret
+
+; subtracts two long numbers
+;    rdi -- address of difference (long number), may be one of the operands
+;    rsi -- address of minuend (long number)
+;    rdx -- address of subtrahend (long number)
+;    rcx -- length of long numbers in qwords
+; result:
+;    rax -- borrow out of the top qword
+sub_long_long:
+                xor             eax, eax
+.loop:
+                mov             r8, [rsi + rax * 8]
+                sbb             r8, [rdx + rax * 8]
+                mov             [rdi + rax * 8], r8
+                lea             rax, [rax + 1]
+                dec             rcx
+                jnz             .loop
+
+                mov             eax, 0
+                adc             eax, 0
+                ret
+
+; multiplies long number by a short
+;    rdi -- address of product (long number), may be the multiplier
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- length of long number in qwords
+;    rcx -- multiplier #2 (64-bit unsigned)
+; result:
+;    rax -- high qword of the product
+mul_long_short:
+                mov             r8, rdx
+                xor             r9d, r9d
+                xor             r10d, r10d
+.loop:
+                mov             rax, [rsi + r10 * 8]
+                mul             rcx
+                add             rax, r9
+                adc             rdx, 0
+                mov             [rdi + r10 * 8], rax
+                mov             r9, rdx
+                inc             r10
+                dec             r8
+                jnz             .loop
+
+                mov             rax, r9
+                ret
+
+; multiplies two long numbers, one row of multiplier #1 per qword of multiplier #2
+;    rdi -- address of product (long number of n + m qwords), must not overlap
+;           the multipliers
+;    rsi -- address of multiplier #1 (long number)
+;    rdx -- n, length of multiplier #1 in qwords
+;    rcx -- address of multiplier #2 (long number)
+;    r8  -- m, length of multiplier #2 in qwords
+mul_long_long:
+                push            rbx
+                mov             r9, rdx
+
+; every row writes its top qword, only the first n qwords start at zero
+                xor             eax, eax
+                xor             r10d, r10d
+.zero:
+                mov             [rdi + r10 * 8], rax
+                inc             r10
+                cmp             r10, r9
+                jb              .zero
+
+.row:
+                mov             rbx, [rcx]
+                xor             r11d, r11d
+                xor             r10d, r10d
+.column:
+                mov             rax, [rsi + r10 * 8]
+                mul             rbx
+                add             rax, r11
+                adc             rdx, 0
+                add             rax, [rdi + r10 * 8]
+                adc             rdx, 0
+                mov             [rdi + r10 * 8], rax
+                mov             r11, rdx
+                inc             r10
+                cmp             r10, r9
+                jb              .column
+
+                mov             [rdi + r9 * 8], r11
+                lea             rdi, [rdi + 8]
+                lea             rcx, [rcx + 8]
+                dec             r8
+                jnz             .row
+
+                pop             rbx
+                ret
+
+; divides long number by a short
+;    rdi -- address of quotient (long number), may be the dividend
+;    rsi -- address of dividend (long number)
+;    rdx -- length of long number in qwords
+;    rcx -- divisor (64-bit unsigned, not zero)
+; result:
+;    rax -- remainder
+div_long_short:
+                mov             r8, rdx
+                xor             edx, edx
+.loop:
+                mov             rax, [rsi + r8 * 8 - 8]
+                div             rcx
+                mov             [rdi + r8 * 8 - 8], rax
+                dec             r8
+                jnz             .loop
+
+                mov             rax, rdx
+                ret
+
+                section         .note.GNU-stack noalloc noexec nowrite progbits
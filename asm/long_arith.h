@@ -0,0 +1,32 @@
+#ifndef LONG_ARITH_H
+#define LONG_ARITH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* The routines of long_arith.asm. Long numbers are arrays of qwords, least
+ * significant first, and every length must be positive */
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* r[0, n) = a[0, n) + b[0, n); returns the carry. r may be a or b */
+uint64_t add_long_long(uint64_t *r, uint64_t const *a, uint64_t const *b, size_t n);
+
+/* r[0, n) = a[0, n) - b[0, n); returns the borrow. r may be a or b */
+uint64_t sub_long_long(uint64_t *r, uint64_t const *a, uint64_t const *b, size_t n);
+
+/* r[0, n) = a[0, n) * b; returns the high qword. r may be a */
+uint64_t mul_long_short(uint64_t *r, uint64_t const *a, size_t n, uint64_t b);
+
+/* r[0, n + m) = a[0, n) * b[0, m); r must not overlap a or b */
+void mul_long_long(uint64_t *r, uint64_t const *a, size_t n, uint64_t const *b, size_t m);
+
+/* q[0, n) = a[0, n) / d for d != 0; returns the remainder. q may be a */
+uint64_t div_long_short(uint64_t *q, uint64_t const *a, size_t n, uint64_t d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include "long_arith.h"
+#include "../bigint/mpn.h"
+
+// times the routines of long_arith.asm against the limb kernels of bigint on
+// the same operands and checks that both give the same results
+
+namespace {
+typedef std::vector<uint64_t> number;
+
+number random_number(std::mt19937_64 &gen, size_t n) {
+    number res(n);
+    for (uint64_t &x : res) {
+        x = gen();
+    }
+    return res;
+}
+
+// runs body iterations times after one warm-up call, returns ns per call
+template <typename F>
+double measure(size_t iterations, F body) {
+    body();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        body();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+void report(char const *name, size_t n, double nasm, double cpp) {
+    std::printf("%-14s %5zu qwords %12.1f ns %12.1f ns %8.2f\n", name, n, nasm, cpp, cpp / nasm);
+}
+
+void check(bool ok, char const *name, size_t n) {
+    if (!ok) {
+        std::fprintf(stderr, "%s differs from mpn at %zu qwords\n", name, n);
+        std::abort();
+    }
+}
+}
+
+int main() {
+    std::mt19937_64 gen(1);
+    std::printf("%-14s %12s %15s %15s %9s\n", "routine", "length", "nasm", "mpn", "mpn/nasm");
+    for (size_t n : {4, 16, 64, 256, 1024, 4096}) {
+        number a = random_number(gen, n), b = random_number(gen, n);
+        number r1(2 * n), r2(2 * n);
+        uint64_t d = gen() | 1;
+        size_t linear = (1 << 24) / n;
+        size_t quadratic = (1 << 24) / (n * n) + 1;
+        uint64_t c1 = 0, c2 = 0;
+
+        double nasm = measure(linear, [&] { c1 = add_long_long(r1.data(), a.data(), b.data(), n); });
+        double cpp = measure(linear, [&] { c2 = mpn::add_n(r2.data(), a.data(), b.data(), n); });
+        check(c1 == c2 && r1 == r2, "add_long_long", n);
+        report("add_long_long", n, nasm, cpp);
+
+        nasm = measure(linear, [&] { c1 = sub_long_long(r1.data(), a.data(), b.data(), n); });
+        cpp = measure(linear, [&] { c2 = mpn::sub_n(r2.data(), a.data(), b.data(), n); });
+        check(c1 == c2 && r1 == r2, "sub_long_long", n);
+        report("sub_long_long", n, nasm, cpp);
+
+        nasm = measure(linear, [&] { c1 = mul_long_short(r1.data(), a.data(), n, d); });
+        cpp = measure(linear, [&] { c2 = mpn::mul_1(r2.data(), a.data(), n, d); });
+        check(c1 == c2 && r1 == r2, "mul_long_short", n);
+        report("mul_long_short", n, nasm, cpp);
+
+        nasm = measure(quadratic, [&] { mul_long_long(r1.data(), a.data(), n, b.data(), n); });
+        cpp = measure(quadratic, [&] { mpn::mul_basecase(r2.data(), a.data(), n, b.data(), n); });
+        check(r1 == r2, "mul_long_long", n);
+        report("mul_long_long", n, nasm, cpp);
+
+        // a division by a full qword takes tens of cycles, fewer iterations do
+        nasm = measure(linear / 8, [&] { c1 = div_long_short(r1.data(), a.data(), n, d); });
+        cpp = measure(linear / 8, [&] { c2 = mpn::divrem_1(r2.data(), a.data(), n, d); });
+        check(c1 == c2 && r1 == r2, "div_long_short", n);
+        report("div_long_short", n, nasm, cpp);
+    }
+    return 0;
+}
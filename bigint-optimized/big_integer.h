@@ -1,17 +1,36 @@
 #ifndef BIG_INTEGER_H
 #define BIG_INTEGER_H
 
+#include <cstdint>
+#ifdef BIGINT_ATOMIC_REFCOUNT
+#include <atomic>
+#endif
 #include <string>
-#include <functional>
 #include <vector>
+#include "../bigint/mpn.h"
+
+struct divmod_result;
 
 struct big_integer {
-    static const size_t MAX_STATIC_SIZE = 2;
+    // the whole arithmetic is written in terms of limb_t, the limbs of the
+    // kernels in mpn.h that big_integer stores
+    typedef mpn::limb_t limb_t;
+    typedef mpn::double_limb_t double_limb_t;
+
+    // limbs stored in the object itself, define BIGINT_INLINE_LIMBS to change;
+    // the object is one word and the inline limbs, 256 bits in 40 bytes by default
+#ifdef BIGINT_INLINE_LIMBS
+    static const size_t MAX_STATIC_SIZE = BIGINT_INLINE_LIMBS;
+#else
+    static const size_t MAX_STATIC_SIZE = 32 / sizeof(limb_t);
+#endif
 
     big_integer();
 
     big_integer(big_integer const &);
 
+    big_integer(big_integer &&) noexcept;
+
     big_integer(int32_t);
 
     big_integer(uint32_t);
@@ -22,6 +41,8 @@ struct big_integer {
 
     big_integer &operator=(big_integer const &);
 
+    big_integer &operator=(big_integer &&) noexcept;
+
     big_integer operator+() const;
 
     big_integer operator-() const;
@@ -68,79 +89,159 @@ struct big_integer {
 
     friend bool operator<=(big_integer const &, big_integer const &);
 
+    friend big_integer operator*(big_integer const &, big_integer const &);
+
+    friend big_integer operator-(big_integer const &, big_integer &&);
+
     friend std::string to_string(big_integer);
 
+    // how divmod rounds the quotient: towards zero, as operator/ does, towards
+    // minus infinity, or so that the remainder is never negative
+    enum class rounding { truncate, floor, euclidean };
+
+    friend divmod_result divmod(big_integer const &, big_integer const &, rounding);
+
+    // makes room for values of up to the given number of bits, and the carry of
+    // one more addition, so that they are computed in place without reallocating
+    void reserve(size_t);
+
+    // counters of the copy-on-write storage, summed over all threads
+    struct stats {
+        // times a buffer shared with other values was copied to be written
+        size_t detaches;
+    };
+
+    static stats get_stats();
+
 private:
     struct my_buffer {
-        struct static_buffer {
-            size_t size_;
-            uint32_t data_[MAX_STATIC_SIZE];
-        };
+        // define BIGINT_ATOMIC_REFCOUNT to make copies of one value in different
+        // threads safe; writing a value that another thread reads still races
+#ifdef BIGINT_ATOMIC_REFCOUNT
+        typedef std::atomic<size_t> ref_counter_t;
+#else
+        typedef size_t ref_counter_t;
+#endif
 
         struct dynamic_buffer {
-            size_t ref_counter;
-            size_t size_;
-            uint32_t data_[];
+            ref_counter_t ref_counter;
+            size_t capacity_;
+            limb_t data_[];
         };
         my_buffer();
 
         my_buffer(size_t);
 
+        static dynamic_buffer *allocate(size_t &);
+
+        static void deallocate(dynamic_buffer *);
+
         my_buffer(my_buffer const &);
 
+        my_buffer(my_buffer &&) noexcept;
+
         ~my_buffer();
 
         size_t size() const;
 
-        uint32_t const *data() const;
+        limb_t const *data() const;
 
-        uint32_t *non_const_data();
+        limb_t *non_const_data();
 
         void swap(my_buffer &);
 
+        size_t capacity() const;
+
+        void set_size(size_t);
+
+        bool is_unique() const;
+
         void change_capacity(size_t);
 
-        bool is_static;
+        bool is_static() const;
+
+        bool is_negative() const;
+
+        void set_negative(bool);
+
+        // the size times four, plus two for a negative value and one if the limbs
+        // are in dynamic_buf. The size and sign are kept here even for a shared
+        // block, as only its owner writes them
+        size_t tagged_size;
         union {
-            static_buffer static_buf;
+            limb_t static_data[MAX_STATIC_SIZE];
             dynamic_buffer *dynamic_buf;
         };
     };
 
+    // magnitude, least significant limb first, without leading zero limbs, and sign
     my_buffer buf;
 
-    big_integer &apply_operation(big_integer const &, std::function<uint32_t(uint32_t, uint32_t)> const &);
+    template <typename Op>
+    big_integer &apply_operation(big_integer const &);
+
+    limb_t div_by_limb(limb_t divisor);
+
+    static void long_divide(big_integer const &, big_integer const &, big_integer &, big_integer &);
 
-    uint32_t div_by_uint32_t(uint32_t divisor);
+    static void divide(big_integer const &, big_integer const &, big_integer &, big_integer &);
 
-    static uint32_t get_trial_multiplier(big_integer const &r, big_integer const &d, size_t m, size_t k);
+    struct capacity_tag {};
 
-    bool smaller(big_integer const &, size_t, size_t) const;
+    big_integer(size_t, capacity_tag);
 
-    void difference(big_integer const &, size_t, size_t);
+    static big_integer from_limb(limb_t);
 
-    static void long_divide(big_integer &, big_integer &, big_integer &, big_integer &);
+    static std::vector<big_integer> const &decimal_powers(size_t);
 
-    static void divide(big_integer, big_integer, big_integer &, big_integer &);
+    static big_integer read_decimal(char const *, size_t);
+
+    static void write_decimal(big_integer, size_t, std::string &);
 
     bool sign() const;
 
-    void change_data(std::vector<uint32_t> &);
+    void set_sign(bool);
+
+    bool is_zero() const;
+
+    static int compare_magnitude(big_integer const &, big_integer const &);
+
+    big_integer &add_signed(big_integer const &, bool);
+
+    void change_data(std::vector<limb_t> &, bool);
 
-    void clear_empty_slots();
+    limb_t *reserve_data(size_t);
 
-    uint32_t const *data() const;
+    void set_data_size(size_t, bool);
 
-    uint32_t *non_const_data();
+    limb_t const *data() const;
+
+    limb_t *non_const_data();
 
     void swap(big_integer &);
 };
 
+// a == quotient * b + remainder
+struct divmod_result {
+    big_integer quotient;
+    big_integer remainder;
+};
+
+// both results of one division, rounded as asked
+divmod_result divmod(big_integer const &a, big_integer const &b,
+                     big_integer::rounding mode = big_integer::rounding::truncate);
+
+// the overloads taking the right operand as an rvalue reuse its storage for the result
+
 big_integer operator+(big_integer, big_integer const &);
 
+big_integer operator+(big_integer const &, big_integer &&);
+
 big_integer operator-(big_integer, big_integer const &);
 
-big_integer operator*(big_integer, big_integer const &);
+big_integer operator-(big_integer const &, big_integer &&);
+
+big_integer operator*(big_integer const &, big_integer const &);
 
 big_integer operator/(big_integer, big_integer const &);
 
@@ -148,10 +249,16 @@ big_integer operator%(big_integer, big_integer const &);
 
 big_integer operator&(big_integer, big_integer const &);
 
+big_integer operator&(big_integer const &, big_integer &&);
+
 big_integer operator^(big_integer, big_integer const &);
 
+big_integer operator^(big_integer const &, big_integer &&);
+
 big_integer operator|(big_integer, big_integer const &);
 
+big_integer operator|(big_integer const &, big_integer &&);
+
 big_integer operator>>(big_integer, int);
 
 big_integer operator<<(big_integer, int);
@@ -0,0 +1,92 @@
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+#include "big_integer.h"
+#include "../bigint/allocation_counter.h"
+
+namespace {
+// a value of the given number of random bits, of random sign
+big_integer random_value(std::mt19937 &gen, size_t bits) {
+    big_integer res = 0;
+    for (size_t i = 0; i < bits; i += 31) {
+        res <<= 31;
+        res += static_cast<uint32_t>(gen() >> 1);
+    }
+    res >>= (bits + 30) / 31 * 31 - bits;
+    return gen() % 2 == 0 ? res : -res;
+}
+
+// operands whose bit lengths are drawn from the given weights of 64, 128,
+// 192 and 256 bits
+std::vector<big_integer> operands(std::vector<unsigned> const &weights) {
+    std::mt19937 gen(1);
+    std::discrete_distribution<size_t> length(weights.begin(), weights.end());
+    std::vector<big_integer> res;
+    for (size_t i = 0; i < 1024; i++) {
+        res.push_back(random_value(gen, 64 * (length(gen) + 1)));
+    }
+    return res;
+}
+
+// runs body over every pair of neighbouring operands after one warm-up pass
+// and prints the time and the heap allocations per operation
+template <typename F>
+void run(char const *name, std::vector<big_integer> const &v, F body) {
+    size_t const passes = 200;
+    for (size_t i = 0; i + 1 < v.size(); i++) {
+        body(v[i], v[i + 1]);
+    }
+    size_t allocations_before = allocation_count();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t pass = 0; pass < passes; pass++) {
+        for (size_t i = 0; i + 1 < v.size(); i++) {
+            body(v[i], v[i + 1]);
+        }
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    double ops = static_cast<double>(passes * (v.size() - 1));
+    std::printf("    %-16s %8.1f ns/op %6.2f allocations/op\n", name, elapsed.count() / ops,
+                (allocation_count() - allocations_before) / ops);
+}
+}
+
+int main() {
+    std::printf("%zu inline limbs, sizeof(big_integer) = %zu\n", big_integer::MAX_STATIC_SIZE, sizeof(big_integer));
+    struct distribution {
+        char const *name;
+        std::vector<unsigned> weights;
+    };
+    std::vector<distribution> distributions = {
+        {"64 bits", {1, 0, 0, 0}},
+        {"128 bits", {0, 1, 0, 0}},
+        {"256 bits", {0, 0, 0, 1}},
+        {"mixed 70/20/5/5", {70, 20, 5, 5}},
+    };
+    for (distribution const &d : distributions) {
+        std::printf("  %s\n", d.name);
+        std::vector<big_integer> v = operands(d.weights);
+        big_integer sink;
+        run("copy", v, [&](big_integer const &a, big_integer const &) {
+            big_integer c = a;
+            sink ^= c;
+        });
+        run("a + b", v, [&](big_integer const &a, big_integer const &b) {
+            big_integer c = a + b;
+            sink ^= c;
+        });
+        run("a * b", v, [&](big_integer const &a, big_integer const &b) {
+            big_integer c = a * b;
+            sink ^= c;
+        });
+        run("a * b / b", v, [&](big_integer const &a, big_integer const &b) {
+            big_integer c = a * b / b;
+            sink ^= c;
+        });
+        big_integer acc;
+        run("acc += a", v, [&](big_integer const &a, big_integer const &) {
+            acc += a;
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+#include "big_integer.h"
+#include "../bigint/allocation_counter.h"
+
+namespace {
+big_integer number(size_t digits) {
+    std::string s;
+    for (size_t i = 0; i < digits; i++) {
+        s.push_back('1' + i * 7 % 9);
+    }
+    return big_integer(s);
+}
+
+// hands tasks out to the given number of threads until all are done and
+// prints the time and the heap allocations per task
+template <typename F>
+void run(char const *name, size_t threads, size_t tasks, F task) {
+    std::atomic<size_t> next(0);
+    size_t allocations_before = allocation_count();
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+    for (size_t t = 0; t < threads; t++) {
+        pool.emplace_back([&] {
+            for (size_t i; (i = next.fetch_add(1)) < tasks;) {
+                task(i);
+            }
+        });
+    }
+    for (std::thread &thread : pool) {
+        thread.join();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    size_t count = allocation_count() - allocations_before;
+    std::printf("%-28s %2zu threads %10.1f ns/task %8.2f allocations/task\n", name, threads,
+                elapsed.count() / tasks, static_cast<double>(count) / tasks);
+}
+}
+
+int main() {
+    size_t max_threads = std::max(4u, std::thread::hardware_concurrency());
+    big_integer const modulus = number(3000);
+    std::string const modulus_string = to_string(modulus);
+    std::vector<big_integer> powers(1, number(100));
+    for (size_t i = 1; i < 8; i++) {
+        powers.push_back(powers.back() * powers.back());
+    }
+    std::vector<std::string> power_strings;
+    for (big_integer const &p : powers) {
+        power_strings.push_back(to_string(p));
+    }
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        std::atomic<size_t> below(0);
+        run("share modulus and power", threads, 100000, [&](size_t i) {
+            big_integer m = modulus;
+            big_integer p = powers[i % powers.size()];
+            below.fetch_add(p < m, std::memory_order_relaxed);
+        });
+        run("parse modulus and power", threads, 1000, [&](size_t i) {
+            big_integer m(modulus_string);
+            big_integer p(power_strings[i % power_strings.size()]);
+            below.fetch_add(p < m, std::memory_order_relaxed);
+        });
+        // the five shortest powers are below the modulus
+        if (below.load() != (100000 + 1000) / powers.size() * 5) {
+            std::printf("wrong comparisons\n");
+            return 1;
+        }
+    }
+    if (to_string(modulus) != modulus_string) {
+        std::printf("modulus changed\n");
+        return 1;
+    }
+    return 0;
+}
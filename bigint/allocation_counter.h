@@ -0,0 +1,10 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstddef>
+
+// the heap allocations made by the program so far. Linking allocation_counter.cpp
+// replaces the global operator new, the benchmarks of both variants share it
+size_t allocation_count();
+
+#endif
@@ -1,108 +1,146 @@
+#include <algorithm>
 #include <cstring>
+#include <stdexcept>
 #include "big_integer.h"
 
-static const uint64_t UINT32MOD = 1ull << 32u;
+typedef big_integer::limb_t limb_t;
+typedef big_integer::double_limb_t double_limb_t;
 
-uint32_t const *big_integer::data() const {
-    return buf.data();
+static const unsigned LIMB_BITS = sizeof(limb_t) * 8;
+static const double_limb_t LIMB_BASE = static_cast<double_limb_t>(1) << LIMB_BITS;
+static const limb_t LIMB_MAX = ~static_cast<limb_t>(0);
+
+// to_string prints the number in chunks of DECIMAL_DIGITS digits
+static const limb_t DECIMAL_BASE = sizeof(limb_t) == 8 ? 10000000000000000000ull : 1000000000u;
+static const size_t DECIMAL_DIGITS = sizeof(limb_t) == 8 ? 19 : 9;
+
+// numbers of at least this many limbs are converted from and to decimal by divide and conquer
+static const size_t DECIMAL_DC_THRESHOLD = 32;
+
+// the one limb of a moved-from value
+static const limb_t ZERO_LIMB = 0;
+
+limb_t const *big_integer::data() const {
+    return buf.empty() ? &ZERO_LIMB : buf.data();
 }
 
-uint32_t *big_integer::non_const_data() {
-    return const_cast<uint32_t *>(buf.data());
+// the number of limbs of the magnitude, at least one
+size_t big_integer::data_size() const {
+    return buf.empty() ? 1 : buf.size();
+}
+
+limb_t *big_integer::non_const_data() {
+    return const_cast<limb_t *>(buf.data());
 }
 
 void big_integer::swap(big_integer &y) {
     buf.swap(y.buf);
+    std::swap(negative, y.negative);
 }
 
 bool big_integer::sign() const {
-    return data()[buf.size() - 1] & (1u << 31u);
+    return negative;
 }
 
-void big_integer::change_data(std::vector<uint32_t> &new_buf) {
-    size_t sz = new_buf.size() - 1;
-    if (new_buf.size() != 1 && (new_buf[sz] == 0 || new_buf[sz] == UINT32_MAX)) {
-        uint32_t head = new_buf[sz];
-        for (; sz > 0 && new_buf[sz - 1] == head; sz--);
-        if (sz && ((new_buf[sz] & (1u << 31u)) == (new_buf[sz - 1] & (1u << 31u)))) {
-            sz--;
-        }
-    }
-    new_buf.resize(sz + 1);
-    new_buf.shrink_to_fit();
+bool big_integer::is_zero() const {
+    return data_size() == 1 && data()[0] == 0;
+}
+
+void big_integer::change_data(std::vector<limb_t> &new_buf, bool negative_) {
     buf.swap(new_buf);
+    set_data_size(buf.size(), negative_);
 }
 
-void big_integer::clear_empty_slots() {
-    std::vector<uint32_t> new_data(buf);
-    change_data(new_data);
+// makes the magnitude writable in place with room for n limbs and returns it;
+// limbs past the old size are zero and the size becomes at least n. An empty
+// magnitude becomes n zero limbs
+limb_t *big_integer::reserve_data(size_t n) {
+    if (n > buf.size()) {
+        buf.resize(n);
+    }
+    return buf.data();
 }
 
-big_integer::big_integer() : buf(1) {
-    buf[0] = 0;
+void big_integer::reserve(size_t bits) {
+    buf.reserve((bits + LIMB_BITS - 1) / LIMB_BITS + 1);
 }
 
-big_integer::big_integer(int32_t a) : buf(1) {
-    buf[0] = *reinterpret_cast<uint32_t *>(&a);
+// keeps the low n limbs of the magnitude without leading zeros and sets the sign
+void big_integer::set_data_size(size_t n, bool negative_) {
+    for (; n > 1 && buf[n - 1] == 0; n--);
+    buf.resize(n);
+    negative = negative_ && !is_zero();
 }
 
-big_integer::big_integer(uint32_t a) {
-    if (a > INT32_MAX) {
-        buf.resize(2);
-        buf[0] = a;
-        buf[1] = 0;
-    } else {
-        buf.resize(1);
-        buf[0] = a;
-    }
+big_integer::big_integer() : buf(1), negative(false) {}
+
+big_integer::big_integer(int32_t a) : buf(1), negative(a < 0) {
+    buf[0] = a < 0 ? -static_cast<limb_t>(a) : a;
+}
+
+big_integer::big_integer(uint32_t a) : buf(1), negative(false) {
+    buf[0] = a;
+}
+
+big_integer big_integer::from_limb(limb_t a) {
+    big_integer res;
+    res.buf[0] = a;
+    return res;
 }
 
 big_integer::~big_integer() = default;
 
 big_integer::big_integer(big_integer const &other) = default;
 
-big_integer::big_integer(std::string const &str) : buf(1) {
-    big_integer mul(1);
-    buf[0] = 0;
-    size_t len = str.length(), start = 0;
-    bool sign_ = false;
-    if (str[0] == '-') {
-        sign_ = true;
-        start = 1;
-    }
-    while (len >= start + 9) {
-        len -= 9;
-        *this += mul * big_integer(std::stoi(str.substr(len, 9)));
-        mul *= big_integer(1000000000);
-    }
-    if (len > start) {
-        *this += mul * (std::stoi(str.substr(start, len - start)));
-    }
-    if (sign_) {
-        *this = -*this;
-    }
+// the moved-from value is zero, with an empty magnitude
+big_integer::big_integer(big_integer &&other) noexcept : buf(std::move(other.buf)), negative(other.negative) {
+    other.negative = false;
+}
+
+// zero with room for n limbs
+big_integer::big_integer(size_t n, capacity_tag) : buf(), negative(false) {
+    buf.reserve(n);
+    buf.push_back(0);
+}
+
+big_integer::big_integer(std::string const &str) : buf(1), negative(false) {
+    bool negative_sign = !str.empty() && str[0] == '-';
+    size_t start = !str.empty() && (str[0] == '-' || str[0] == '+') ? 1 : 0;
+    big_integer res = read_decimal(str.data() + start, str.length() - start);
+    swap(res);
+    negative = negative_sign && !is_zero();
 }
 
 big_integer &big_integer::operator=(big_integer const &other) {
+    buf = other.buf;
+    negative = other.negative;
+    return *this;
+}
+
+// the moved-from value is zero, with an empty magnitude
+big_integer &big_integer::operator=(big_integer &&other) noexcept {
     if (this != &other) {
-        std::vector<uint32_t> copy(other.buf);
-        buf.swap(copy);
+        buf = std::move(other.buf);
+        other.buf.clear();
+        negative = other.negative;
+        other.negative = false;
     }
     return *this;
 }
 
+int big_integer::compare_magnitude(big_integer const &a, big_integer const &b) {
+    if (a.data_size() != b.data_size()) {
+        return a.data_size() < b.data_size() ? -1 : 1;
+    }
+    return mpn::cmp(a.data(), b.data(), a.data_size());
+}
+
 bool operator>(big_integer const &a, big_integer const &b) {
     if (a.sign() != b.sign()) {
         return b.sign();
     }
-    if (a.buf.size() == b.buf.size()) {
-        for (size_t i = a.buf.size(); i > 0; --i) {
-            if (a.data()[i - 1] != b.data()[i - 1]) {
-                return a.data()[i - 1] > b.data()[i - 1];
-            }
-        }
-    }
-    return a.buf.size() > b.buf.size();
+    int cmp = big_integer::compare_magnitude(a, b);
+    return a.sign() ? cmp < 0 : cmp > 0;
 }
 
 bool operator<(big_integer const &a, big_integer const &b) {
@@ -118,7 +156,9 @@ bool operator>=(big_integer const &a, big_integer const &b) {
 }
 
 big_integer big_integer::operator-() const {
-    return ~*this + 1;
+    big_integer res(*this);
+    res.negative = !negative && !is_zero();
+    return res;
 }
 
 big_integer big_integer::operator+() const {
@@ -126,156 +166,215 @@ big_integer big_integer::operator+() const {
 }
 
 bool operator==(big_integer const &a, big_integer const &b) {
-    if (a.buf.size() == b.buf.size()) {
-        for (size_t i = 0; i < a.buf.size(); i++) {
-            if (a.data()[i] != b.data()[i]) {
-                return false;
-            }
-        }
-    } else {
-        return false;
-    }
-    return true;
+    return a.sign() == b.sign() && big_integer::compare_magnitude(a, b) == 0;
 }
 
 bool operator!=(big_integer const &a, big_integer const &b) {
     return !(a == b);
 }
 
-big_integer &big_integer::operator+=(big_integer const &rhs) {
-    bool this_sign = sign(), rhs_sign = rhs.sign();
-    uint32_t to_add = 0;
-    size_t i = 0;
-    if ((buf.size() < rhs.buf.size() && this_sign) || (buf.size() > rhs.buf.size() && rhs_sign)) {
-        to_add = UINT32_MAX;
-    }
-    uint32_t const *bigger_data = this->data();
-    if (buf.size() < rhs.buf.size()) {
-        bigger_data = rhs.data();
-    }
-    std::vector<uint32_t> vector(std::max(rhs.buf.size(), buf.size()) + 1);
-    uint64_t rc = 0;
-    for (; i < std::min(rhs.buf.size(), buf.size()); i++) {
-        rc += static_cast<uint64_t>(this->data()[i]) + rhs.data()[i];
-        vector[i] = rc % UINT32MOD;
-        rc = rc >= UINT32MOD;
-    }
-    for (; i < vector.size() - 1; i++) {
-        rc += static_cast<uint64_t>(bigger_data[i]) + to_add;
-        vector[i] = rc % UINT32MOD;
-        rc = rc >= UINT32MOD;
-    }
-    vector[vector.size() - 1] = rc != 0 ? UINT32_MAX : 0;
-    if (this_sign != rhs_sign) {
-        vector[vector.size() - 1] = ((1u << 31u) & vector[vector.size() - 2]) ? UINT32_MAX : 0;
-    }
-    change_data(vector);
+big_integer &big_integer::add_signed(big_integer const &rhs, bool rhs_negative) {
+    // the result is written over this magnitude, rhs is read only after
+    // reserve_data as it may be *this
+    size_t n = data_size(), m = rhs.data_size();
+    if (n == 1 && m == 1) {
+        // single limbs are added in a machine word unless the sum carries out
+        limb_t a = data()[0], b = rhs.data()[0], sum;
+        if (negative != rhs_negative) {
+            reserve_data(1)[0] = a < b ? b - a : a - b;
+            negative = (a < b ? rhs_negative : negative) && a != b;
+            return *this;
+        }
+        if (!__builtin_add_overflow(a, b, &sum)) {
+            reserve_data(1)[0] = sum;
+            return *this;
+        }
+    }
+    if (negative == rhs_negative) {
+        limb_t *r = reserve_data(std::max(n, m) + 1);
+        limb_t const *b = rhs.data();
+        if (n >= m) {
+            r[n] = mpn::add(r, r, n, b, m);
+        } else {
+            r[m] = mpn::add(r, b, m, r, n);
+        }
+        set_data_size(std::max(n, m) + 1, negative);
+        return *this;
+    }
+    int cmp = compare_magnitude(*this, rhs);
+    limb_t *r = reserve_data(std::max(n, m));
+    limb_t const *b = rhs.data();
+    if (cmp >= 0) {
+        mpn::sub(r, r, n, b, m);
+        set_data_size(n, negative);
+    } else {
+        mpn::sub(r, b, m, r, n);
+        set_data_size(m, rhs_negative);
+    }
     return *this;
 }
 
-big_integer &big_integer::operator-=(big_integer const &rhs) {
-    *this += -rhs;
-    return *this;
+big_integer &big_integer::operator+=(big_integer const &rhs) {
+    return add_signed(rhs, rhs.negative);
 }
 
-big_integer &big_integer::operator*=(big_integer const& other) {
-    bool this_sign = sign(), rhs_sign = other.sign();
-    size_t size_a = this->buf.size(), size_b = other.buf.size();
-    const uint32_t *a = this->data(), *b = other.data();
-    big_integer c, d;
-    if (this_sign) {
-        c = -*this;
-        a = c.data();
-        size_a = c.buf.size();
-    }
-    if (rhs_sign) {
-        d = -other;
-        b = d.data();
-        size_b = d.buf.size();
-    }
-    std::vector<uint32_t> res_data(size_a + size_b + 1, 0);
-    for (size_t i = 0; i < size_a; i++) {
-        uint64_t dop = 0;
-        uint32_t rc = 0;
-        for (size_t j = 0; j < size_b; j++) {
-            dop = static_cast<uint64_t>(a[i]) * b[j] + res_data[i + j] + rc;
-            res_data[i + j] = dop % UINT32MOD;
-            rc = dop >> 32u;
-        }
-        res_data[size_b + i] = rc;
-    }
-    big_integer res;
-    res.change_data(res_data);
-    if (this_sign ^ rhs_sign) {
-        *this = -res;
-    } else {
-        swap(res);
+big_integer &big_integer::operator-=(big_integer const &rhs) {
+    return add_signed(rhs, !rhs.negative);
+}
+
+big_integer operator*(big_integer const &lhs, big_integer const &rhs) {
+    // single limbs are multiplied in a machine word unless the product overflows
+    limb_t product;
+    if (lhs.data_size() == 1 && rhs.data_size() == 1 &&
+        !__builtin_mul_overflow(lhs.data()[0], rhs.data()[0], &product)) {
+        big_integer res = big_integer::from_limb(product);
+        res.negative = lhs.negative != rhs.negative && product != 0;
+        return res;
+    }
+    bool square = big_integer::compare_magnitude(lhs, rhs) == 0;
+    size_t size_a = lhs.data_size(), size_b = rhs.data_size();
+    const limb_t *a = lhs.data(), *b = square ? a : rhs.data();
+    if (size_a < size_b) {
+        std::swap(a, b);
+        std::swap(size_a, size_b);
+    }
+    // the product cannot overlap its operands; one spare limb lets a following
+    // addition carry without reallocating
+    big_integer res(size_a + size_b + 1, big_integer::capacity_tag());
+    limb_t *r = res.reserve_data(size_a + size_b);
+    std::vector<limb_t> scratch(mpn::mul_scratch_size(size_a));
+    mpn::mul(r, a, size_a, b, size_b, scratch.data());
+    res.set_data_size(size_a + size_b, lhs.negative != rhs.negative);
+    return res;
+}
+
+big_integer &big_integer::operator*=(big_integer const &other) {
+    limb_t product;
+    if (data_size() == 1 && other.data_size() == 1 &&
+        !__builtin_mul_overflow(data()[0], other.data()[0], &product)) {
+        reserve_data(1)[0] = product;
+        negative = negative != other.negative && product != 0;
+        return *this;
     }
+    big_integer res = *this * other;
+    swap(res);
     return *this;
 }
 
 big_integer &big_integer::operator/=(big_integer const &rhs) {
-    big_integer d, r;
-    divide(*this, rhs, d, r);
-    if (this->sign() ^ rhs.sign()) {
-        d = -d;
-    } else {
-        d.clear_empty_slots();
+    if (data_size() == 1 && rhs.data_size() == 1 && rhs.data()[0] != 0) {
+        limb_t quotient = data()[0] / rhs.data()[0];
+        reserve_data(1)[0] = quotient;
+        negative = negative != rhs.negative && quotient != 0;
+        return *this;
     }
-    swap(d);
+    divmod_result res = divmod(*this, rhs);
+    swap(res.quotient);
     return *this;
 }
 
 big_integer &big_integer::operator%=(big_integer const &rhs) {
-    big_integer d, r;
-    divide(*this, rhs, d, r);
-    if (this->sign()) {
-        *this = -r;
-    } else {
-        swap(r);
+    if (data_size() == 1 && rhs.data_size() == 1 && rhs.data()[0] != 0) {
+        limb_t remainder = data()[0] % rhs.data()[0];
+        reserve_data(1)[0] = remainder;
+        negative = negative && remainder != 0;
+        return *this;
     }
+    divmod_result res = divmod(*this, rhs);
+    swap(res.remainder);
     return *this;
 }
 
 big_integer big_integer::operator~() const {
-    std::vector<uint32_t> new_data(buf.size());
-    for (size_t i = 0; i < buf.size(); i++) {
-        new_data[i] = ~this->data()[i];
+    return -*this - 1;
+}
+
+// the operations of &=, |= and ^= on limbs and on arrays of limbs
+struct and_op {
+    limb_t operator()(limb_t a, limb_t b) const {
+        return a & b;
+    }
+
+    void operator()(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr) const {
+        mpn::and_n(r, a, b, n, ma, mb, mr);
+    }
+};
+
+struct or_op {
+    limb_t operator()(limb_t a, limb_t b) const {
+        return a | b;
+    }
+
+    void operator()(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr) const {
+        mpn::ior_n(r, a, b, n, ma, mb, mr);
+    }
+};
+
+struct xor_op {
+    limb_t operator()(limb_t a, limb_t b) const {
+        return a ^ b;
     }
-    big_integer cop;
-    cop.change_data(new_data);
-    return cop;
+
+    void operator()(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr) const {
+        mpn::xor_n(r, a, b, n, ma, mb, mr);
+    }
+};
+
+// limb i of the two's complement of a negative magnitude x, ~(x - 1), whose lowest
+// nonzero limb is x[k]; past k it is ~x[i]
+static limb_t twos_complement_limb(limb_t const *x, size_t i, size_t k) {
+    return i < k ? 0 : i == k ? -x[i] : ~x[i];
 }
 
-big_integer &big_integer::apply_operation(big_integer const &other,
-                                          std::function<uint32_t(uint32_t, uint32_t)> const &func) {
-    std::vector<uint32_t> new_data(std::max(buf.size(), other.buf.size()));
-    size_t i = 0;
-    for (; i < std::min(buf.size(), other.buf.size()); ++i) {
-        new_data[i] = func(this->data()[i], other.data()[i]);
+template <typename Op>
+big_integer &big_integer::apply_operation(big_integer const &other) {
+    // both operands are read in two's complement, one limb longer than the longest
+    // magnitude so that the sign bit is free. Past the lowest nonzero limb of both
+    // negative operands that is a plain complement, done by the masks of the kernel
+    size_t n = data_size(), m = other.data_size(), len = std::max(n, m) + 1;
+    bool a_negative = negative, b_negative = other.negative;
+    Op op;
+    bool res_negative = op(a_negative ? LIMB_MAX : 0, b_negative ? LIMB_MAX : 0) != 0;
+    limb_t ma = a_negative ? LIMB_MAX : 0, mb = b_negative ? LIMB_MAX : 0, mr = res_negative ? LIMB_MAX : 0;
+    limb_t *r = reserve_data(len);
+    limb_t const *b = other.data();
+    size_t ka = 0, kb = 0, low = 0;
+    if (a_negative) {
+        for (; r[ka] == 0; ka++);
+        low = ka + 1;
     }
-    uint32_t to_add = !other.sign() ? 0 : UINT32_MAX;
-    for (; i < buf.size(); i++) {
-        new_data[i] = func(this->data()[i], to_add);
+    if (b_negative) {
+        for (; b[kb] == 0; kb++);
+        low = std::max(low, kb + 1);
     }
-    to_add = !sign() ? 0 : UINT32_MAX;
-    for (; i < other.buf.size(); i++) {
-        new_data[i] = func(other.data()[i], to_add);
+    // the result is complemented when negative and incremented below, -t = ~t + 1
+    for (size_t i = 0; i < low; i++) {
+        limb_t x = a_negative ? twos_complement_limb(r, i, ka) : r[i];
+        limb_t y = i >= m ? mb : b_negative ? twos_complement_limb(b, i, kb) : b[i];
+        r[i] = op(x, y) ^ mr;
     }
-    change_data(new_data);
+    if (low < m) {
+        op(r + low, r + low, b + low, m - low, ma, mb, mr);
+    }
+    size_t tail = std::max(low, m);
+    op(r + tail, r + tail, nullptr, len - tail, ma, mb, mr);
+    if (res_negative) {
+        for (size_t i = 0; i < len && ++r[i] == 0; i++);
+    }
+    set_data_size(len, res_negative);
     return *this;
 }
 
 big_integer &big_integer::operator&=(big_integer const &rhs) {
-    return apply_operation(rhs, [](uint32_t a, uint32_t b) { return a & b; });
+    return apply_operation<and_op>(rhs);
 }
 
 big_integer &big_integer::operator^=(big_integer const &rhs) {
-    return apply_operation(rhs, [](uint32_t a, uint32_t b) { return a ^ b; });
+    return apply_operation<xor_op>(rhs);
 }
 
 big_integer &big_integer::operator|=(big_integer const &rhs) {
-    return apply_operation(rhs, [](uint32_t a, uint32_t b) { return a | b; });
+    return apply_operation<or_op>(rhs);
 }
 
 big_integer &big_integer::operator<<=(int rhs) {
@@ -285,28 +384,19 @@ big_integer &big_integer::operator<<=(int rhs) {
     if (rhs < 0) {
         return *this >>= -rhs;
     }
-    uint32_t big_shift = rhs / 32u, shift = rhs % 32u;
-    uint64_t rc = 0, dop = 0;
-    std::vector<uint32_t> mas(buf.size() + big_shift
-                              + ((static_cast<uint64_t>(data()[buf.size() - 1]) << shift) >= (1u << 31u)));
-    for (size_t i = 0; i < big_shift; i++) mas[i] = 0;
-    for (size_t i = 0; i < buf.size(); i++) {
-        dop = static_cast<uint64_t>(data()[i]) << shift;
-        mas[i + big_shift] = (dop % UINT32MOD) + rc;
-        rc = dop >> 32u;
-    }
-    if (mas.size() > buf.size() + big_shift) {
-        mas[mas.size() - 1] = rc;
-    }
-    if (sign()) {
-        uint64_t i = 1;
-        while (i <= mas[mas.size() - 1] && i <= (1u << 31u)) i <<= 1u;
-        while (i <= (1u << 31u)) {
-            mas[mas.size() - 1] ^= i;
-            i <<= 1u;
-        }
+    size_t big_shift = rhs / LIMB_BITS;
+    unsigned shift = rhs % LIMB_BITS;
+    size_t n = data_size();
+    limb_t *r = reserve_data(n + big_shift + 1);
+    // whole limbs move up with one memmove, or in the same pass as the bits
+    if (shift == 0) {
+        std::memmove(r + big_shift, r, n * sizeof(limb_t));
+        r[n + big_shift] = 0;
+    } else {
+        r[n + big_shift] = mpn::lshift(r + big_shift, r, n, shift);
     }
-    change_data(mas);
+    std::fill(r, r + big_shift, 0);
+    set_data_size(n + big_shift + 1, negative);
     return *this;
 }
 
@@ -317,199 +407,277 @@ big_integer &big_integer::operator>>=(int rhs) {
     if (rhs < 0) {
         return *this <<= -rhs;
     }
-    uint32_t big_shift = rhs / 32u, shift = rhs % 32u;
-    if (big_shift > buf.size()) {
-        *this = 0;
+    size_t big_shift = rhs / LIMB_BITS;
+    unsigned shift = rhs % LIMB_BITS;
+    size_t n = data_size();
+    if (big_shift >= n) {
+        reserve_data(1)[0] = negative ? 1 : 0;
+        set_data_size(1, negative);
         return *this;
     }
-    uint32_t next = 0;
-    uint64_t dp = 0;
-    std::vector<uint32_t> mas(buf.size() - big_shift);
-    for (size_t i = buf.size(); i > big_shift; i--) {
-        dp = (static_cast<uint64_t>(data()[i - 1])) << (32u - shift);
-        mas[i - 1 - big_shift] = (dp >> 32u) + next;
-        next = dp % UINT32MOD;
-    }
-    if (sign()) {
-        uint64_t i = 1;
-        while (i <= mas[mas.size() - 1] && i <= (1u << 31u)) i <<= 1u;
-        while (i <= (1u << 31u)) {
-            mas[mas.size() - 1] ^= i;
-            i <<= 1u;
+    // negative values are rounded towards minus infinity, as in two's complement:
+    // the magnitude grows by one when a nonzero bit is shifted out. The search
+    // stops at the first nonzero limb, which is nearly always the lowest one
+    bool round_down = negative && std::find_if(data(), data() + big_shift, [](limb_t x) {
+        return x != 0;
+    }) != data() + big_shift;
+    limb_t *r = reserve_data(n);
+    size_t len = n - big_shift;
+    if (shift == 0) {
+        std::memmove(r, r + big_shift, len * sizeof(limb_t));
+    } else {
+        round_down |= mpn::rshift(r, r + big_shift, len, shift) != 0;
+    }
+    if (negative && round_down) {
+        // the magnitude grows by one limb only if a whole limb was shifted out
+        size_t i = 0;
+        for (; i < len && ++r[i] == 0; i++);
+        if (i == len) {
+            r[len++] = 1;
         }
     }
-    change_data(mas);
+    set_data_size(len, negative);
     return *this;
 }
 
+// powers[i] = DECIMAL_BASE^(2^i) for i <= k. The table is kept per thread and shared
+// by all conversions, the returned reference is valid until the next call
+std::vector<big_integer> const &big_integer::decimal_powers(size_t k) {
+    static thread_local std::vector<big_integer> powers(1, from_limb(DECIMAL_BASE));
+    while (powers.size() <= k) {
+        powers.push_back(powers.back() * powers.back());
+    }
+    return powers;
+}
+
+// the number written by the decimal digits s[0, len). Long strings are split so
+// that the low part has DECIMAL_DIGITS * 2^i digits, at most half of them, and
+// the halves are combined with one cached power
+big_integer big_integer::read_decimal(char const *s, size_t len) {
+    if (len < DECIMAL_DIGITS * DECIMAL_DC_THRESHOLD) {
+        std::vector<limb_t> limbs(len / DECIMAL_DIGITS + 1);
+        size_t used = 0;
+        for (size_t pos = 0; pos < len;) {
+            size_t end = pos + (pos == 0 && len % DECIMAL_DIGITS ? len % DECIMAL_DIGITS : DECIMAL_DIGITS);
+            limb_t chunk = 0;
+            for (; pos < end; pos++) {
+                if (s[pos] < '0' || s[pos] > '9') {
+                    throw std::invalid_argument("Invalid decimal digit");
+                }
+                chunk = chunk * 10 + (s[pos] - '0');
+            }
+            double_limb_t rc = chunk;
+            for (size_t i = 0; i < used; i++) {
+                rc += static_cast<double_limb_t>(limbs[i]) * DECIMAL_BASE;
+                limbs[i] = rc % LIMB_BASE;
+                rc >>= LIMB_BITS;
+            }
+            if (rc != 0) {
+                limbs[used++] = rc;
+            }
+        }
+        big_integer res;
+        res.change_data(limbs, false);
+        return res;
+    }
+    size_t i = 0;
+    while ((DECIMAL_DIGITS << (i + 1)) * 2 <= len) {
+        i++;
+    }
+    size_t low_len = DECIMAL_DIGITS << i;
+    big_integer res = read_decimal(s, len - low_len);
+    res *= decimal_powers(i)[i];
+    return res += read_decimal(s + len - low_len, low_len);
+}
+
+// appends the decimal digits of x >= 0, padded with zeros to at least width digits.
+// Long numbers are split by the largest cached power of at most half their length
+void big_integer::write_decimal(big_integer x, size_t width, std::string &out) {
+    if (x.data_size() < DECIMAL_DC_THRESHOLD) {
+        std::vector<limb_t> chunks;
+        while (!x.is_zero()) {
+            chunks.push_back(x.div_by_limb(DECIMAL_BASE));
+        }
+        std::string digits;
+        if (!chunks.empty()) {
+            digits = std::to_string(chunks.back());
+            chunks.pop_back();
+        }
+        for (size_t i = chunks.size(); i > 0; i--) {
+            std::string chunk = std::to_string(chunks[i - 1]);
+            digits.append(DECIMAL_DIGITS - chunk.length(), '0');
+            digits.append(chunk);
+        }
+        if (digits.length() < width) {
+            out.append(width - digits.length(), '0');
+        }
+        out.append(digits);
+        return;
+    }
+    size_t i = 0;
+    while (decimal_powers(i + 1)[i + 1].data_size() * 2 <= x.data_size() + 1) {
+        i++;
+    }
+    size_t low_width = DECIMAL_DIGITS << i;
+    big_integer q, r;
+    divide(x, decimal_powers(i)[i], q, r);
+    write_decimal(q, width > low_width ? width - low_width : 0, out);
+    write_decimal(r, low_width, out);
+}
+
 std::string to_string(big_integer val) {
-    if (val == 0) {
+    if (val.is_zero()) {
         return "0";
     }
-    std::string st, cop;
+    std::string st;
     if (val.sign()) {
         st = "-";
-        val = -val;
-    }
-    std::vector<uint32_t> mas;
-    big_integer q, r;
-    while (val.buf.size() > 1 || val.data()[0] != 0) {
-        mas.push_back(val.div_by_uint32_t(1000000000));
-    }
-    st.append(std::to_string(mas[mas.size() - 1]));
-    for (size_t i = mas.size() - 1; i > 0; i--) {
-        cop = std::to_string(mas[i - 1]);
-        for (size_t j = 0; j < 9 - cop.length(); j++) {
-            st.append("0");
-        }
-        st.append(cop);
+        val.negative = false;
     }
+    big_integer::write_decimal(val, 0, st);
     return st;
 }
 
 big_integer operator+(big_integer a, big_integer const &b) {
-    return a += b;
+    a += b;
+    return a;
+}
+
+big_integer operator+(big_integer const &a, big_integer &&b) {
+    b += a;
+    return std::move(b);
 }
 
 big_integer operator-(big_integer a, big_integer const &b) {
-    return a -= b;
+    a -= b;
+    return a;
 }
 
-big_integer operator*(big_integer a, big_integer const &b) {
-    return a *= b;
+big_integer operator-(big_integer const &a, big_integer &&b) {
+    // a - b = -b + a
+    b.negative = !b.negative && !b.is_zero();
+    b += a;
+    return std::move(b);
 }
 
 big_integer operator/(big_integer a, big_integer const &b) {
-    return a /= b;
+    a /= b;
+    return a;
 }
 
 big_integer operator%(big_integer a, big_integer const &b) {
-    return a %= b;
+    a %= b;
+    return a;
 }
 
 big_integer operator&(big_integer a, big_integer const &b) {
-    return a &= b;
+    a &= b;
+    return a;
+}
+
+big_integer operator&(big_integer const &a, big_integer &&b) {
+    b &= a;
+    return std::move(b);
 }
 
 big_integer operator^(big_integer a, big_integer const &b) {
-    return a ^= b;
+    a ^= b;
+    return a;
 }
 
-big_integer operator|(big_integer a, big_integer const &b) {
-    return a |= b;
+big_integer operator^(big_integer const &a, big_integer &&b) {
+    b ^= a;
+    return std::move(b);
 }
 
-big_integer operator>>(big_integer a, int b) {
-    return a >>= b;
+big_integer operator|(big_integer a, big_integer const &b) {
+    a |= b;
+    return a;
 }
 
-big_integer operator<<(big_integer a, int b) {
-    return a <<= b;
+big_integer operator|(big_integer const &a, big_integer &&b) {
+    b |= a;
+    return std::move(b);
 }
 
-uint32_t big_integer::get_trial_multiplier(big_integer const &r, big_integer const &d, size_t m, size_t k) {
-    uint32_t km = m + k - 1;
-    uint64_t rr = (static_cast<uint64_t> (r.data()[km]) << 32u) + r.data()[km - 1];
-    uint64_t dd = d.data()[m - 1];
-    return std::min(rr / dd, static_cast<uint64_t>(UINT32_MAX));
+big_integer operator>>(big_integer a, int b) {
+    a >>= b;
+    return a;
 }
 
-bool big_integer::smaller(big_integer const &dq, size_t k, size_t m) const {
-    uint32_t i = m;
-    for (; 0 < i; i--) {
-        if (data()[i + k - 1] != dq.data()[i - 1]) {
-            return data()[i + k - 1] < dq.data()[i - 1];
-        }
+big_integer operator<<(big_integer a, int b) {
+    a <<= b;
+    return a;
+}
+
+// the magnitudes of x / y and x % y, for y of at least two limbs. Both are shifted
+// left until the top bit of y is set, the remainder is shifted back
+void big_integer::long_divide(big_integer const &x, big_integer const &y, big_integer &d, big_integer &r) {
+    size_t m = y.data_size(), n = x.data_size() + 1;
+    unsigned shift = __builtin_clzll(y.data()[m - 1]) - (64 - LIMB_BITS);
+    // the shifted divisor goes in front of the scratch of divrem
+    std::vector<limb_t> rem(n), quotient(n - m), scratch((shift != 0 ? m : 0) + mpn::div_scratch_size(m));
+    limb_t const *yn = y.data();
+    if (shift == 0) {
+        std::copy(x.data(), x.data() + n - 1, rem.begin());
+    } else {
+        rem[n - 1] = mpn::lshift(rem.data(), x.data(), n - 1, shift);
+        mpn::lshift(scratch.data(), yn, m, shift);
+        yn = scratch.data();
     }
-    return false;
-}
-
-void big_integer::difference(big_integer const &dq, size_t k, size_t m) {
-    int64_t borrow = 0;
-    for (size_t i = 0; i < m; i++) {
-        uint64_t diff = static_cast<uint64_t> (data()[i + k - 1]) + UINT32MOD - dq.data()[i] - borrow;
-        non_const_data()[i + k - 1] = diff % UINT32MOD;
-        borrow = 1 - diff / UINT32MOD;
-    }
-}
-
-void big_integer::long_divide(big_integer &x, big_integer &y, big_integer &d, big_integer &r) {
-    size_t n, m = y.buf.size(), xs;
-    for (; m > 0 && y.data()[m - 1] == 0; m--);
-    uint32_t f = UINT32MOD / (1ull + y.data()[m - 1]);
-    y *= big_integer(f);
-    m = y.buf.size();
-    for (; m > 0 && y.data()[m - 1] == 0; m--);
-    r = x * big_integer(f);
-    n = r.buf.size();
-    d.buf.resize(n - m + 1);
-    d.non_const_data()[d.buf.size() - 1] = 0;
-    for (size_t k = n - m; k > 0; --k) {
-        if (r.data()[k + m - 1] || r.data()[k + m - 2]) {
-            uint32_t qt = get_trial_multiplier(r, y, m, k);
-            if (qt == 0) {
-                d.non_const_data()[k - 1] = 0;
-            } else {
-                x = y * big_integer(qt);
-                xs = m + 1;
-                while (r.smaller(x, k - 1, xs)) {
-                    qt--;
-                    if (qt == 0) {
-                        d.non_const_data()[k - 1] = 0;
-                        break;
-                    }
-                    x = y * qt;
-                    xs = m + 1;
-                }
-                if (qt == 0) {
-                    continue;
-                }
-                d.non_const_data()[k - 1] = qt;
-                r.difference(x, k, xs);
-            }
-        } else {
-            d.non_const_data()[k - 1] = 0;
-        }
+    mpn::divrem(quotient.data(), rem.data(), n, yn, m, scratch.data() + (shift != 0 ? m : 0));
+    if (shift != 0) {
+        mpn::rshift(rem.data(), rem.data(), m, shift);
     }
-    r.div_by_uint32_t(f);
+    rem.resize(m);
+    d.change_data(quotient, false);
+    r.change_data(rem, false);
 }
 
-void big_integer::divide(big_integer x, big_integer y, big_integer &d, big_integer &r) {
-    if (x == 0) {
-        d = 0;
-        return;
-    }
-    if (y == 0) {
+// the quotient truncated towards zero and the remainder with the sign of x;
+// d and r must not be x or y
+void big_integer::divide(big_integer const &x, big_integer const &y, big_integer &d, big_integer &r) {
+    if (y.is_zero()) {
         throw std::overflow_error("Divide by zero exception");
     }
-    if (x.sign()) {
-        x = -x;
-    }
-    if (y.sign()) {
-        y = -y;
-    }
-    if (y.buf.size() > x.buf.size()) {
+    if (compare_magnitude(x, y) < 0) {
         d = 0;
-        r.swap(x);
+        r = x;
         return;
     }
-    if (y.buf.size() == 1 || (y.buf.size() == 2 && y.data()[1] == 0)) {
-        d.swap(x);
-        r = d.div_by_uint32_t(y.data()[0]);
+    if (y.data_size() == 1) {
+        d = x;
+        r = from_limb(d.div_by_limb(y.data()[0]));
     } else {
         long_divide(x, y, d, r);
     }
-}
-
-uint32_t big_integer::div_by_uint32_t(uint32_t divisor) {
-    std::vector<uint32_t> cop_data(buf.size());
-    uint32_t mod = 0;
-    for (size_t i = buf.size(); i > 0; i--) {
-        uint64_t rc = (static_cast<uint64_t>(mod) << 32u) + data()[i - 1];
-        cop_data[i - 1] = rc / divisor;
-        mod = rc % divisor;
-    }
-    change_data(cop_data);
+    d.negative = x.negative != y.negative && !d.is_zero();
+    r.negative = x.negative && !r.is_zero();
+}
+
+divmod_result divmod(big_integer const &a, big_integer const &b, big_integer::rounding mode) {
+    divmod_result res;
+    big_integer::divide(a, b, res.quotient, res.remainder);
+    // the truncated remainder has the sign of a; floor gives it the sign of b and
+    // euclidean makes it non-negative, by moving one multiple of b
+    big_integer &q = res.quotient, &r = res.remainder;
+    bool adjust = mode == big_integer::rounding::floor ? !r.is_zero() && r.negative != b.negative
+                                                       : mode == big_integer::rounding::euclidean && r.negative;
+    if (adjust && r.negative != b.negative) {
+        q -= 1;
+        r += b;
+    } else if (adjust) {
+        q += 1;
+        r -= b;
+    }
+    return res;
+}
+
+limb_t big_integer::div_by_limb(limb_t divisor) {
+    size_t n = data_size();
+    limb_t *r = reserve_data(n);
+    limb_t mod = mpn::divrem_1(r, r, n, divisor);
+    set_data_size(n, negative);
     return mod;
 }
 
@@ -524,13 +692,11 @@ big_integer big_integer::operator++(int) {
 }
 
 big_integer &big_integer::operator--() {
-    return *this += -1;
+    return *this -= 1;
 }
 
 big_integer big_integer::operator--(int) {
     big_integer copy(*this);
-    *this += -1;
+    *this -= 1;
     return copy;
 }
-
-
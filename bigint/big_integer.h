@@ -1,15 +1,25 @@
 #ifndef BIG_INTEGER_H
 #define BIG_INTEGER_H
 
+#include <cstdint>
 #include <string>
-#include <functional>
 #include <vector>
+#include "mpn.h"
+
+struct divmod_result;
 
 struct big_integer {
+    // the magnitude is stored in the limbs of the kernels in mpn.h, define
+    // BIGINT_LIMB32 to build with 32-bit limbs
+    typedef mpn::limb_t limb_t;
+    typedef mpn::double_limb_t double_limb_t;
+
     big_integer();
 
     big_integer(big_integer const &);
 
+    big_integer(big_integer &&) noexcept;
+
     big_integer(int32_t);
 
     big_integer(uint32_t);
@@ -20,6 +30,8 @@ struct big_integer {
 
     big_integer &operator=(big_integer const &);
 
+    big_integer &operator=(big_integer &&) noexcept;
+
     big_integer operator+() const;
 
     big_integer operator-() const;
@@ -66,43 +78,93 @@ struct big_integer {
 
     friend bool operator<=(big_integer const &, big_integer const &);
 
+    friend big_integer operator*(big_integer const &, big_integer const &);
+
+    friend big_integer operator-(big_integer const &, big_integer &&);
+
     friend std::string to_string(big_integer);
 
+    // how divmod rounds the quotient: towards zero, as operator/ does, towards
+    // minus infinity, or so that the remainder is never negative
+    enum class rounding { truncate, floor, euclidean };
+
+    friend divmod_result divmod(big_integer const &, big_integer const &, rounding);
+
     void swap(big_integer &);
 
+    // makes room for values of up to the given number of bits, and the carry of
+    // one more addition, so that they are computed in place without reallocating
+    void reserve(size_t);
+
 private:
-    std::vector<uint32_t> buf;
+    // magnitude, least significant limb first, without leading zero limbs. A
+    // moved-from value keeps an empty vector, which reads as zero
+    std::vector<limb_t> buf;
+    bool negative;
+
+    template <typename Op>
+    big_integer &apply_operation(big_integer const &);
 
-    big_integer &apply_operation(big_integer const &, std::function<uint32_t(uint32_t, uint32_t)> const &);
+    limb_t div_by_limb(limb_t divisor);
 
-    uint32_t div_by_uint32_t(uint32_t divisor);
+    static void long_divide(big_integer const &, big_integer const &, big_integer &, big_integer &);
 
-    static uint32_t get_trial_multiplier(big_integer const &r, big_integer const &d, size_t m, size_t k);
+    static void divide(big_integer const &, big_integer const &, big_integer &, big_integer &);
 
-    bool smaller(big_integer const &, size_t, size_t) const;
+    struct capacity_tag {};
 
-    void difference(big_integer const &, size_t, size_t);
+    big_integer(size_t, capacity_tag);
 
-    static void long_divide(big_integer &, big_integer &, big_integer &, big_integer &);
+    static big_integer from_limb(limb_t);
 
-    static void divide(big_integer, big_integer, big_integer &, big_integer &);
+    static std::vector<big_integer> const &decimal_powers(size_t);
+
+    static big_integer read_decimal(char const *, size_t);
+
+    static void write_decimal(big_integer, size_t, std::string &);
 
     bool sign() const;
 
-    void change_data(std::vector<uint32_t> &);
+    bool is_zero() const;
+
+    static int compare_magnitude(big_integer const &, big_integer const &);
 
-    void clear_empty_slots();
+    big_integer &add_signed(big_integer const &, bool);
 
-    uint32_t const *data() const;
+    void change_data(std::vector<limb_t> &, bool);
 
-    uint32_t *non_const_data();
+    limb_t *reserve_data(size_t);
+
+    void set_data_size(size_t, bool);
+
+    limb_t const *data() const;
+
+    size_t data_size() const;
+
+    limb_t *non_const_data();
 };
 
+// a == quotient * b + remainder
+struct divmod_result {
+    big_integer quotient;
+    big_integer remainder;
+};
+
+// both results of one division, rounded as asked
+divmod_result divmod(big_integer const &a, big_integer const &b,
+                     big_integer::rounding mode = big_integer::rounding::truncate);
+
+// the overloads taking the right operand as an rvalue reuse its storage for the result
+
 big_integer operator+(big_integer, big_integer const &);
 
+big_integer operator+(big_integer const &, big_integer &&);
+
 big_integer operator-(big_integer, big_integer const &);
 
-big_integer operator*(big_integer, big_integer const &);
+big_integer operator-(big_integer const &, big_integer &&);
+
+big_integer operator*(big_integer const &, big_integer const &);
 
 big_integer operator/(big_integer, big_integer const &);
 
@@ -110,10 +172,16 @@ big_integer operator%(big_integer, big_integer const &);
 
 big_integer operator&(big_integer, big_integer const &);
 
+big_integer operator&(big_integer const &, big_integer &&);
+
 big_integer operator^(big_integer, big_integer const &);
 
+big_integer operator^(big_integer const &, big_integer &&);
+
 big_integer operator|(big_integer, big_integer const &);
 
+big_integer operator|(big_integer const &, big_integer &&);
+
 big_integer operator>>(big_integer, int);
 
 big_integer operator<<(big_integer, int);
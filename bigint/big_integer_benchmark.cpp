@@ -0,0 +1,192 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include "big_integer.h"
+#include "allocation_counter.h"
+
+namespace {
+big_integer number(size_t digits) {
+    std::string s;
+    for (size_t i = 0; i < digits; i++) {
+        s.push_back('1' + i * 7 % 9);
+    }
+    return big_integer(s);
+}
+
+// removes and returns a random element of v
+big_integer extract(std::vector<big_integer> &v, std::mt19937 &gen) {
+    size_t k = gen() % v.size();
+    big_integer res = std::move(v[k]);
+    v[k] = std::move(v.back());
+    v.pop_back();
+    return res;
+}
+
+// runs body iterations times after one warm-up call and prints the time and
+// the heap allocations per iteration and in total
+template <typename F>
+void run(char const *name, size_t iterations, F body) {
+    body();
+    size_t allocations_before = allocation_count();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        body();
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    size_t count = allocation_count() - allocations_before;
+    std::printf("%-24s %10.1f ns/op %8.2f allocations/op %8zu in total\n", name, elapsed.count() / iterations,
+                static_cast<double>(count) / iterations, count);
+}
+}
+
+int main() {
+    {
+        big_integer acc = 1, x = number(19);
+        run("acc += x; acc <<= 1", 100000, [&] {
+            acc += x;
+            acc <<= 1;
+        });
+        big_integer shifted = 1;
+        run("shifted <<= 1", 100000, [&] {
+            shifted <<= 1;
+        });
+        big_integer reserved = 1;
+        reserved.reserve(200000);
+        run("reserved <<= 1", 100000, [&] {
+            reserved <<= 1;
+        });
+    }
+    {
+        // values that fit in a machine word, against the same operations on int64_t
+        big_integer a = 123456789, b = -98765;
+        run("small a += b; a -= b", 1000000, [&] {
+            a += b;
+            a -= b;
+        });
+        run("small a *= b; a /= b", 1000000, [&] {
+            a *= b;
+            a /= b;
+        });
+        run("small c = a * b % a", 1000000, [&] {
+            big_integer c = a * b % a;
+        });
+        volatile int64_t x = 123456789, y = -98765;
+        run("int64 a += b; a -= b", 1000000, [&] {
+            x += y;
+            x -= y;
+        });
+        run("int64 a *= b; a /= b", 1000000, [&] {
+            x *= y;
+            x /= y;
+        });
+    }
+    {
+        // the pattern of mul_merge_randomized: many short-lived products of a few limbs
+        std::mt19937 gen(1);
+        std::vector<big_integer> factors;
+        for (size_t i = 0; i < 1000; i++) {
+            factors.emplace_back(static_cast<uint32_t>(gen() % 2000000000 + 1));
+        }
+        run("merge 1000 factors", 20, [&] {
+            std::vector<big_integer> v = factors;
+            while (v.size() >= 2) {
+                big_integer a = extract(v, gen);
+                big_integer b = extract(v, gen);
+                big_integer ab = a * b;
+                if (ab / a != b || ab / b != a) {
+                    std::abort();
+                }
+                v.push_back(std::move(ab));
+            }
+        });
+    }
+    {
+        // bitwise operations stream both operands once
+        big_integer a = number(1900000), b = number(1900000) >> 5, nb = -b;
+        run("a ^= b, 100k limbs", 100, [&] {
+            a ^= b;
+        });
+        run("a &= b, 100k limbs", 100, [&] {
+            big_integer c = a;
+            c &= b;
+        });
+        run("a |= -b, 100k limbs", 100, [&] {
+            big_integer c = a;
+            c |= nb;
+        });
+    }
+    {
+        // shifts move the limbs once, negative values included
+        big_integer a = -number(1900000);
+        run("a <<= 3; a >>= 3, 100k limbs", 100, [&] {
+            a <<= 3;
+            a >>= 3;
+        });
+        run("a <<= 640; a >>= 640, 100k limbs", 100, [&] {
+            a <<= 640;
+            a >>= 640;
+        });
+    }
+    for (size_t limbs : {100, 1000, 10000}) {
+        // 2n by n limb divisions, as in div_randomized but larger
+        big_integer a = number(limbs * 38), b = number(limbs * 19);
+        std::string name = "a / b, " + std::to_string(limbs) + " limbs";
+        run(name.c_str(), 100000 / limbs, [&] {
+            big_integer c = a / b;
+        });
+    }
+    for (size_t digits : {20, 300, 3000}) {
+        std::printf("%zu digits\n", digits);
+        big_integer a = number(digits), b = number(digits / 2 + 1);
+        run("a += b; a -= b", 100000, [&] {
+            a += b;
+            a -= b;
+        });
+        run("a -= b; a += b", 100000, [&] {
+            a -= b;
+            a += b;
+        });
+        run("a <<= 65; a >>= 65", 100000, [&] {
+            a <<= 65;
+            a >>= 65;
+        });
+        run("a <<= 64; a >>= 64", 100000, [&] {
+            a <<= 64;
+            a >>= 64;
+        });
+        run("a ^= b; a ^= b", 100000, [&] {
+            a ^= b;
+            a ^= b;
+        });
+        run("c = a; c += b", 100000, [&] {
+            big_integer c = a;
+            c += b;
+        });
+        run("c = a; c |= b; c &= b", 100000, [&] {
+            big_integer c = a;
+            c |= b;
+            c &= b;
+        });
+        run("a * b", 10000, [&] {
+            big_integer c = a * b;
+        });
+        big_integer c = number(digits / 3 + 1), d = number(digits / 4 + 1);
+        run("a * b + c - d", 10000, [&] {
+            big_integer e = a * b + c - d;
+        });
+        run("c - (a * b)", 10000, [&] {
+            big_integer e = c - (a * b);
+        });
+        run("a / c; a % c", 10000, [&] {
+            big_integer q = a / c, r = a % c;
+        });
+        run("divmod(a, c)", 10000, [&] {
+            divmod_result qr = divmod(a, c);
+        });
+    }
+    return 0;
+}
@@ -52,6 +52,102 @@ TEST(correctness, copy_ctor_real_copy2) {
   EXPECT_EQ(3, a);
 }
 
+TEST(correctness, copy_ctor_real_copy_long) {
+  big_integer a("123456789012345678901234567890123456789012345678901234567890");
+  big_integer b = a;
+  a += 1;
+  a -= 7;
+  a <<= 3;
+  a >>= 100;
+  a &= b;
+  a /= 3;
+
+  EXPECT_EQ(b, big_integer("123456789012345678901234567890123456789012345678901234567890"));
+}
+
+TEST(correctness, self_operations_long) {
+  big_integer a("-123456789012345678901234567890123456789012345678901234567890");
+  big_integer b = a;
+  a += a;
+  EXPECT_EQ(a, b * 2);
+  a -= a;
+  EXPECT_EQ(a, 0);
+  a = b;
+  a &= a;
+  EXPECT_EQ(a, b);
+  a ^= a;
+  EXPECT_EQ(a, 0);
+}
+
+TEST(correctness, move_ctor_and_assignment) {
+  big_integer a("123456789012345678901234567890123456789012345678901234567890");
+  big_integer b(std::move(a));
+  EXPECT_EQ(b, big_integer("123456789012345678901234567890123456789012345678901234567890"));
+  a = std::move(b);
+  EXPECT_EQ(a, big_integer("123456789012345678901234567890123456789012345678901234567890"));
+  b = 5;
+  EXPECT_EQ(5, b);
+}
+
+TEST(correctness, moved_from_is_zero) {
+  big_integer a("-123456789012345678901234567890123456789012345678901234567890");
+  big_integer b(std::move(a));
+  EXPECT_EQ(to_string(a), "0");
+  EXPECT_EQ(a, 0);
+  a += 7;
+  EXPECT_EQ(a, 7);
+  big_integer c = 5;
+  c = std::move(b);
+  EXPECT_EQ(to_string(b), "0");
+  EXPECT_TRUE(c < b);
+  b -= 3;
+  EXPECT_EQ(b, -3);
+  c = std::move(c);
+  EXPECT_EQ(c, big_integer("-123456789012345678901234567890123456789012345678901234567890"));
+  big_integer d(std::move(c));
+  big_integer e = c;
+  EXPECT_EQ(c * d, 0);
+  EXPECT_EQ(c / d, 0);
+  EXPECT_EQ(c % d, 0);
+  EXPECT_EQ(c | d, d);
+  EXPECT_EQ(c ^ d, d);
+  EXPECT_EQ(c & d, 0);
+  EXPECT_EQ(c << 70, 0);
+  EXPECT_EQ(c >> 3, 0);
+  EXPECT_EQ(-e, 0);
+  EXPECT_EQ(~e, -1);
+  EXPECT_EQ(d + e, d);
+  EXPECT_EQ(e - d, -d);
+}
+
+TEST(correctness, rvalue_right_operand) {
+  big_integer a("-98765432109876543210987654321");
+  big_integer b("12345678901234567890");
+  EXPECT_EQ(a + (b * 2), a + b + b);
+  EXPECT_EQ(a - (b * 2), a - b - b);
+  EXPECT_EQ(b - (b * 1), 0);
+  EXPECT_EQ(a & (b * 1), a & b);
+  EXPECT_EQ(a | (b * 1), a | b);
+  EXPECT_EQ(a ^ (b * 1), a ^ b);
+}
+
+TEST(correctness, reserve) {
+  big_integer a("-123456789012345678901234567890");
+  big_integer b = a;
+  a.reserve(10000);
+  EXPECT_EQ(a, b);
+  for (int i = 0; i != 1000; ++i) {
+    a <<= 7;
+    a += 3;
+  }
+  for (int i = 0; i != 1000; ++i) {
+    a -= 3;
+    a >>= 7;
+  }
+  EXPECT_EQ(a, b);
+  EXPECT_EQ(b, big_integer("-123456789012345678901234567890"));
+}
+
 TEST(correctness, assignment_operator) {
   big_integer a = 4;
   big_integer b = 7;
@@ -591,6 +687,18 @@ int myrand() {
 }
 }
 
+TEST(correctness, to_string_long_zero_runs) {
+  for (size_t len = 1; len <= 40000; len = len * 3 + 1) {
+    std::string power = "1" + std::string(len, '0');
+    std::string nines(len, '9');
+    std::string mixed = "7" + std::string(len, '0') + "3" + std::string(len / 2, '0') + "1";
+    EXPECT_EQ(to_string(big_integer(power)), power);
+    EXPECT_EQ(to_string(big_integer(nines)), nines);
+    EXPECT_EQ(to_string(big_integer(mixed)), mixed);
+    EXPECT_EQ(to_string(-big_integer(mixed)), "-" + mixed);
+  }
+}
+
 TEST(correctness, mul_div_randomized) {
   for (unsigned itn = 0; itn != number_of_iterations; ++itn) {
     std::vector<int> multipliers;
@@ -744,6 +852,74 @@ TEST(correctness_random, mul) {
   }
 }
 
+TEST(correctness_random, mul_long_operands) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, b;
+    a.random(max_size * 16, rng);
+    b.random(max_size * (itn + 1), rng);
+    big_integer_gmp c = a * b;
+    big_integer R = big_integer(to_string(a)) * big_integer(to_string(b));
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+TEST(correctness_random, mul_balanced_long_operands) {
+  std::default_random_engine rng(42);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, b;
+    a.random(max_size * 4 * (itn + 1), rng);
+    b.random(max_size * 4 * (itn + 1) - 32 * itn, rng);
+    big_integer_gmp c = a * b;
+    big_integer R = big_integer(to_string(a)) * big_integer(to_string(b));
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+TEST(correctness_random, mul_huge_operands) {
+  std::default_random_engine rng(42);
+  for (size_t bits = max_size * 8; bits <= max_size * 64; bits *= 2) {
+    big_integer_gmp a, b;
+    a.random(bits, rng);
+    b.random(bits - 1000, rng);
+    big_integer_gmp c = a * b;
+    big_integer R = big_integer(to_string(a)) * big_integer(to_string(b));
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+TEST(correctness_random, sqr) {
+  std::default_random_engine rng(42);
+  for (size_t bits = max_size / 64; bits <= max_size * 16; bits *= 2) {
+    big_integer_gmp a;
+    a.random(bits, rng);
+    big_integer_gmp c = a * a;
+    big_integer R = big_integer(to_string(a));
+    EXPECT_EQ(to_string(c), to_string(R * R));
+    R *= R;
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+TEST(correctness_random, string_conv_leading_zeros) {
+  std::default_random_engine rng(42);
+  for (size_t bits = max_size / 64; bits <= max_size * 16; bits *= 2) {
+    big_integer_gmp a;
+    a.random(bits, rng);
+    std::string s = to_string(a);
+    std::string padded = std::string(bits / 3, '0') + (s[0] == '-' ? s.substr(1) : s);
+    if (s[0] == '-') {
+      padded = "-" + padded;
+    }
+    EXPECT_EQ(to_string(big_integer(padded)), s);
+    if (s[0] != '-') {
+      EXPECT_EQ(to_string(big_integer("+" + padded)), s);
+    }
+  }
+  EXPECT_EQ(big_integer("+0"), big_integer(0));
+  EXPECT_EQ(big_integer("+00123"), big_integer(123));
+}
+
 TEST(correctness_random, div) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
@@ -760,6 +936,100 @@ TEST(correctness_random, div) {
   }
 }
 
+TEST(correctness_random, div_long_operands) {
+  std::default_random_engine rng(322);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a, b;
+    a.random(max_size * 16, rng);
+    b.random(max_size * (itn + 2) - 100 * itn, rng);
+    big_integer_gmp c = a / b;
+    big_integer R = big_integer(to_string(a)) / big_integer(to_string(b));
+    EXPECT_EQ(to_string(c), to_string(R));
+
+    c = a % b;
+    R = big_integer(to_string(a)) % big_integer(to_string(b));
+    EXPECT_EQ(to_string(c), to_string(R));
+  }
+}
+
+TEST(correctness, divmod_rounding) {
+  struct {
+    int a, b, trunc_q, trunc_r, floor_q, floor_r, euclid_q, euclid_r;
+  } const cases[] = {
+      {7, 2, 3, 1, 3, 1, 3, 1},       {-7, 2, -3, -1, -4, 1, -4, 1},
+      {7, -2, -3, 1, -4, -1, -3, 1},  {-7, -2, 3, -1, 3, -1, 4, 1},
+      {6, -2, -3, 0, -3, 0, -3, 0},   {0, -5, 0, 0, 0, 0, 0, 0},
+  };
+  for (auto const &c : cases) {
+    divmod_result t = divmod(c.a, c.b);
+    divmod_result f = divmod(c.a, c.b, big_integer::rounding::floor);
+    divmod_result e = divmod(c.a, c.b, big_integer::rounding::euclidean);
+    EXPECT_EQ(t.quotient, c.trunc_q);
+    EXPECT_EQ(t.remainder, c.trunc_r);
+    EXPECT_EQ(f.quotient, c.floor_q);
+    EXPECT_EQ(f.remainder, c.floor_r);
+    EXPECT_EQ(e.quotient, c.euclid_q);
+    EXPECT_EQ(e.remainder, c.euclid_r);
+  }
+
+  big_integer a("-123456789012345678901234567890123456789012345678901234567890");
+  big_integer b("98765432109876543210987654321");
+  for (big_integer const &x : {a, -a}) {
+    for (big_integer const &y : {b, -b}) {
+      divmod_result t = divmod(x, y);
+      EXPECT_EQ(t.quotient, x / y);
+      EXPECT_EQ(t.remainder, x % y);
+      for (auto mode : {big_integer::rounding::floor, big_integer::rounding::euclidean}) {
+        divmod_result r = divmod(x, y, mode);
+        EXPECT_EQ(r.quotient * y + r.remainder, x);
+        EXPECT_TRUE(r.remainder != 0);
+        EXPECT_EQ(r.remainder < 0, mode == big_integer::rounding::floor && y < 0);
+        EXPECT_TRUE((r.remainder < 0 ? -r.remainder : r.remainder) < b);
+      }
+    }
+  }
+  EXPECT_THROW(divmod(0, 0), std::overflow_error);
+}
+
+TEST(correctness, div_extreme_quotient_digits) {
+  // quotients of all-ones limbs and remainders of d - 1 drive every quotient
+  // digit estimate to its largest value
+  big_integer one = 1;
+  for (int k : {2, 3, 5, 40, 120}) {
+    std::vector<big_integer> divisors = {(one << (64 * k - 1)) + 1, (one << (64 * k)) - 1,
+                                         (one << (64 * k)) - (one << (64 * k - 64)) + 7,
+                                         (one << (64 * k - 1)) + (one << (64 * k - 65)) - 1};
+    for (big_integer const &d : divisors) {
+      for (int m : {1, 3, 60, 130}) {
+        big_integer q = (one << (64 * m)) - 1;
+        for (big_integer const &r : {big_integer(0), d - 1, d / 2}) {
+          big_integer a = q * d + r;
+          EXPECT_EQ(a / d, q);
+          EXPECT_EQ(a % d, r);
+        }
+      }
+    }
+  }
+}
+
+TEST(correctness, carry_chains_of_every_length) {
+  // all-ones limbs carry through every limb, the lengths cover every block
+  // remainder of the row kernels
+  big_integer one = 1;
+  for (int k = 1; k <= 21; k++) {
+    big_integer x = (one << (64 * k)) - 1;
+    EXPECT_EQ(x + 1, one << (64 * k));
+    EXPECT_EQ((one << (64 * k)) - x, 1);
+    EXPECT_EQ(x * x, (one << (128 * k)) - (one << (64 * k + 1)) + 1);
+    for (int j = 1; j < k; j += 3) {
+      big_integer y = (one << (64 * j)) - 1;
+      EXPECT_EQ(x * y, (one << (64 * (k + j))) - (one << (64 * k)) - (one << (64 * j)) + 1);
+      EXPECT_EQ(x * y / y, x);
+      EXPECT_EQ((x * y + y - 1) % y, y - 1);
+    }
+  }
+}
+
 TEST(correctness_random, mod) {
   std::default_random_engine rng(322);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
@@ -796,6 +1066,64 @@ TEST(correctness_random, bitwise) {
   }
 }
 
+TEST(correctness_random, bitwise_signs_and_zero_limbs) {
+  // low zero limbs and differing lengths move the start of the complemented part
+  std::default_random_engine rng(7);
+  for (size_t itn = 0; itn != number_of_iterations * 2; ++itn) {
+    big_integer_gmp a, b;
+    a.random(max_size / 4 * (itn % 5 + 1), rng);
+    b.random(max_size / 4 * (itn % 3 + 1), rng);
+    a += 1;
+    b += 1;
+    a <<= static_cast<int>(itn * 37 % 700);
+    b <<= static_cast<int>(itn * 53 % 900);
+    if (itn % 2 == 1) {
+      a = -a;
+    }
+    if (itn % 4 >= 2) {
+      b = -b;
+    }
+    big_integer A(to_string(a)), B(to_string(b));
+    EXPECT_EQ(to_string(a & b), to_string(A & B));
+    EXPECT_EQ(to_string(a | b), to_string(A | B));
+    EXPECT_EQ(to_string(a ^ b), to_string(A ^ B));
+    EXPECT_EQ(to_string(b & a), to_string(B & A));
+    big_integer C = A;
+    C &= C;
+    EXPECT_EQ(C, A);
+    C |= C;
+    EXPECT_EQ(C, A);
+    C ^= C;
+    EXPECT_EQ(C, 0);
+  }
+}
+
+TEST(correctness_random, word_boundaries) {
+  std::vector<std::string> values;
+  for (char const *v : {"0", "1", "2", "3", "65535", "65536", "4294967295", "4294967296", "4294967297",
+                        "9223372036854775807", "9223372036854775808", "18446744073709551615",
+                        "18446744073709551616", "18446744073709551617"}) {
+    values.push_back(v);
+    values.push_back(std::string("-") + v);
+  }
+  for (std::string const &x : values) {
+    for (std::string const &y : values) {
+      big_integer_gmp a(x), b(y);
+      big_integer A(x), B(y);
+      EXPECT_EQ(to_string(a + b), to_string(A + B));
+      EXPECT_EQ(to_string(a - b), to_string(A - B));
+      EXPECT_EQ(to_string(a * b), to_string(A * B));
+      big_integer C = A;
+      C *= B;
+      EXPECT_EQ(to_string(a * b), to_string(C));
+      if (b != 0) {
+        EXPECT_EQ(to_string(a / b), to_string(A / B));
+        EXPECT_EQ(to_string(a % b), to_string(A % B));
+      }
+    }
+  }
+}
+
 TEST(correctness_random, bit_shifts) {
   std::default_random_engine rng(42);
   for (size_t itn = 0; itn != number_of_iterations; ++itn) {
@@ -809,6 +1137,32 @@ TEST(correctness_random, bit_shifts) {
   }
 }
 
+TEST(correctness_random, bit_shifts_by_whole_words) {
+  // multiples of the limb width move whole limbs; negative values round towards
+  // minus infinity only when a nonzero bit is shifted out
+  int const w = static_cast<int>(sizeof(big_integer::limb_t) * 8);
+  std::default_random_engine rng(11);
+  for (size_t itn = 0; itn != number_of_iterations; ++itn) {
+    big_integer_gmp a;
+    a.random(max_size / 2, rng);
+    a <<= static_cast<int>(itn) * w % (10 * w);
+    if (itn % 2 == 1) {
+      a = -a;
+    }
+    big_integer A(to_string(a));
+    for (int shift : {w, 2 * w, 3 * w, 4 * w, 10 * w, static_cast<int>(itn) * w % (10 * w) + w,
+                      static_cast<int>(itn % 97)}) {
+      EXPECT_EQ(to_string(a << shift), to_string(A << shift));
+      EXPECT_EQ(to_string(a >> shift), to_string(A >> shift));
+      EXPECT_EQ(to_string(a >> shift), to_string(A << -shift));
+    }
+  }
+  EXPECT_EQ(big_integer("-18446744073709551616") >> 64, -1);
+  EXPECT_EQ(big_integer("-18446744073709551617") >> 64, -2);
+  EXPECT_EQ(big_integer("-340282366920938463463374607431768211455") >> 1,
+            big_integer("-170141183460469231731687303715884105728"));
+}
+
 // TODO: extend due to idea
 TEST(correctness_twos_complement, simple) {
   std::string a = "-36893488147419103232"; // -(1 << 65)
@@ -835,3 +1189,112 @@ TEST(correctness_twos_complement, all_ones) {
 
   EXPECT_EQ(to_string(gmp_ans), to_string(your_ans));
 }
+
+namespace {
+// the value of the limbs p[0, n)
+big_integer from_limbs(mpn::limb_t const *p, size_t n) {
+  big_integer res;
+  for (size_t i = n; i > 0; i--) {
+    for (size_t j = sizeof(mpn::limb_t) / sizeof(uint32_t); j > 0; j--) {
+      res <<= 32;
+      res += static_cast<uint32_t>(static_cast<uint64_t>(p[i - 1]) >> (32 * (j - 1)));
+    }
+  }
+  return res;
+}
+}
+
+TEST(mpn, kernels_on_caller_buffers) {
+  // the kernels run on plain vectors, their results are checked against big_integer
+  typedef mpn::limb_t limb_t;
+  std::mt19937_64 rng(17);
+  for (size_t n = 1; n <= 40; n++) {
+    std::vector<limb_t> a(n), b(n), r(n), p(2 * n), q(2 * n), s(n);
+    for (size_t i = 0; i < n; i++) {
+      a[i] = static_cast<limb_t>(rng());
+      b[i] = i % 3 == 0 ? ~static_cast<limb_t>(0) : static_cast<limb_t>(rng());
+    }
+    a[n - 1] |= 1;
+    big_integer A = from_limbs(a.data(), n), B = from_limbs(b.data(), n);
+    big_integer top = big_integer(1) << static_cast<int>(sizeof(limb_t) * 8 * n);
+
+    limb_t carry = mpn::add_n(r.data(), a.data(), b.data(), n);
+    EXPECT_EQ(from_limbs(r.data(), n) + from_limbs(&carry, 1) * top, A + B);
+    EXPECT_EQ(mpn::sub_n(r.data(), r.data(), b.data(), n), carry);
+    EXPECT_EQ(mpn::cmp(r.data(), a.data(), n), 0);
+
+    std::vector<limb_t> scratch(mpn::mul_scratch_size(n));
+    mpn::mul(p.data(), a.data(), n, b.data(), n, scratch.data());
+    EXPECT_EQ(from_limbs(p.data(), 2 * n), A * B);
+    mpn::mul_basecase(q.data(), a.data(), n, b.data(), n);
+    EXPECT_EQ(mpn::cmp(p.data(), q.data(), 2 * n), 0);
+    mpn::sqr_basecase(q.data(), a.data(), n);
+    EXPECT_EQ(from_limbs(q.data(), 2 * n), A * A);
+
+    limb_t d = a[0] | 1;
+    limb_t rem = mpn::divrem_1(q.data(), p.data(), 2 * n, d);
+    EXPECT_EQ(from_limbs(q.data(), 2 * n) * from_limbs(&d, 1) + from_limbs(&rem, 1), A * B);
+
+    unsigned shift = static_cast<unsigned>(n % (sizeof(limb_t) * 8 - 1) + 1);
+    limb_t out = mpn::lshift(s.data(), a.data(), n, shift);
+    EXPECT_EQ(from_limbs(s.data(), n) + (from_limbs(&out, 1) << static_cast<int>(sizeof(limb_t) * 8 * n)),
+              A << static_cast<int>(shift));
+    mpn::rshift(s.data(), s.data(), n, shift);
+    s[n - 1] |= out << (sizeof(limb_t) * 8 - shift);
+    EXPECT_EQ(mpn::cmp(s.data(), a.data(), n), 0);
+  }
+}
+
+namespace {
+// the value of p[0, n) as a GMP integer, independent of the limb width
+void to_mpz(mpz_t res, mpn::limb_t const *p, size_t n) {
+  mpz_import(res, n, -1, sizeof(mpn::limb_t), 0, 0, p);
+}
+}
+
+TEST(mpn, divrem_against_gmp) {
+  // every quotient length up to 2dn + 2 around the thresholds of the recursive
+  // division, then divisors of the Newton threshold whose top quotient block is
+  // a whole block, one limb and half a block
+  typedef mpn::limb_t limb_t;
+  size_t const newton = mpn::DIV_NEWTON_THRESHOLD;
+  std::vector<std::pair<size_t, size_t>> sizes;
+  for (size_t dn : {1, 2, 3, 5, 47, 48, 49, 50, 96, 97}) {
+    for (size_t nn = dn; nn <= 3 * dn + 2; nn++) {
+      sizes.emplace_back(nn, dn);
+    }
+  }
+  for (size_t nn : {2 * newton, 2 * newton + 1, 2 * newton + newton / 2}) {
+    sizes.emplace_back(nn, newton);
+  }
+  std::mt19937_64 rng(23);
+  mpz_t n_, d_, q_, r_, q, r;
+  mpz_inits(n_, d_, q_, r_, q, r, nullptr);
+  for (std::pair<size_t, size_t> const &size : sizes) {
+    size_t nn = size.first, dn = size.second;
+    std::vector<limb_t> np(nn), dp(dn), qp(nn - dn + 1);
+    for (size_t i = 0; i < nn; i++) {
+      np[i] = i % 5 == 0 ? ~static_cast<limb_t>(0) : static_cast<limb_t>(rng());
+    }
+    for (size_t i = 0; i < dn; i++) {
+      dp[i] = static_cast<limb_t>(rng());
+    }
+    dp[dn - 1] |= static_cast<limb_t>(1) << (sizeof(limb_t) * 8 - 1);
+    to_mpz(n_, np.data(), nn);
+    to_mpz(d_, dp.data(), dn);
+    mpz_tdiv_qr(q_, r_, n_, d_);
+    if (dn == 1) {
+      limb_t rem = mpn::divrem_1(qp.data(), np.data(), nn, dp[0]);
+      to_mpz(q, qp.data(), nn);
+      to_mpz(r, &rem, 1);
+    } else {
+      std::vector<limb_t> scratch(mpn::div_scratch_size(dn));
+      qp[nn - dn] = mpn::divrem(qp.data(), np.data(), nn, dp.data(), dn, scratch.data());
+      to_mpz(q, qp.data(), nn - dn + 1);
+      to_mpz(r, np.data(), dn);
+    }
+    EXPECT_EQ(mpz_cmp(q, q_), 0) << "nn = " << nn << ", dn = " << dn;
+    EXPECT_EQ(mpz_cmp(r, r_), 0) << "nn = " << nn << ", dn = " << dn;
+  }
+  mpz_clears(n_, d_, q_, r_, q, r, nullptr);
+}
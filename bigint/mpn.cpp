@@ -0,0 +1,1252 @@
+#include <algorithm>
+#include <cassert>
+#include <vector>
+#include "mpn.h"
+
+// x86-64 always has SSE2, AVX2 is used when the processor has it
+#if defined(__GNUC__) && defined(__x86_64__)
+#define BIGINT_X86_64
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// with 64-bit limbs the multiply-accumulate loops have assembly versions for
+// processors with BMI2 (MULX) and ADX (ADCX, ADOX), selected at startup
+#if defined(BIGINT_X86_64) && !defined(BIGINT_LIMB32)
+#define BIGINT_ADX
+#endif
+
+// the BIGINT_NASM build routes add, sub, mul_1, mul_basecase and divrem_1
+// through the routines of asm/long_arith.asm
+#ifdef BIGINT_NASM
+#ifdef BIGINT_LIMB32
+#error "BIGINT_NASM needs 64-bit limbs"
+#endif
+#include "../asm/long_arith.h"
+#endif
+
+namespace mpn {
+static const unsigned LIMB_BITS = sizeof(limb_t) * 8;
+static const double_limb_t LIMB_BASE = static_cast<double_limb_t>(1) << LIMB_BITS;
+static const limb_t LIMB_MAX = ~static_cast<limb_t>(0);
+static const limb_t SIGN_BIT = static_cast<limb_t>(1) << (LIMB_BITS - 1);
+
+// operands shorter than this many limbs are multiplied by the schoolbook loop
+static const size_t KARATSUBA_THRESHOLD = 32;
+
+// operands of at least this many limbs are split in three parts (Toom-3)
+static const size_t TOOM3_THRESHOLD = 160;
+
+// operands of at least this many limbs (20480 bits) are multiplied through number theoretic transforms
+static const size_t NTT_THRESHOLD = 20480 / LIMB_BITS;
+
+// divisors of at least this many limbs are divided by Burnikel-Ziegler recursion
+static const size_t DIV_DC_THRESHOLD = 48;
+
+static_assert(DIV_NEWTON_THRESHOLD >= 8, "Newton division is checked from divisors of 8 limbs");
+
+// The loops below are the portable versions of the row kernels that every
+// multiplication and division is built from, the dispatching functions
+// after the assembly versions pick one
+
+// r[0, n) = a[0, n) + b[0, m), m <= n; returns the carry out of r[n - 1]
+static limb_t add_generic(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m) {
+    double_limb_t rc = 0;
+    size_t i = 0;
+    for (; i < m; i++) {
+        rc += static_cast<double_limb_t>(a[i]) + b[i];
+        r[i] = rc % LIMB_BASE;
+        rc >>= LIMB_BITS;
+    }
+    for (; i < n; i++) {
+        rc += a[i];
+        r[i] = rc % LIMB_BASE;
+        rc >>= LIMB_BITS;
+    }
+    return rc;
+}
+
+// r[0, n) = a[0, n) - b[0, m), m <= n; returns the borrow out of r[n - 1]
+static limb_t sub_generic(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m) {
+    double_limb_t borrow = 0;
+    size_t i = 0;
+    for (; i < m; i++) {
+        double_limb_t diff = static_cast<double_limb_t>(a[i]) + LIMB_BASE - b[i] - borrow;
+        r[i] = diff % LIMB_BASE;
+        borrow = 1 - diff / LIMB_BASE;
+    }
+    for (; i < n; i++) {
+        double_limb_t diff = static_cast<double_limb_t>(a[i]) + LIMB_BASE - borrow;
+        r[i] = diff % LIMB_BASE;
+        borrow = 1 - diff / LIMB_BASE;
+    }
+    return borrow;
+}
+
+// r[0, n) = a[0, n) * b; returns the high limb of the product
+static limb_t mul_1_generic(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    limb_t rc = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t dop = static_cast<double_limb_t>(a[i]) * b + rc;
+        r[i] = dop % LIMB_BASE;
+        rc = dop >> LIMB_BITS;
+    }
+    return rc;
+}
+
+// r[0, n) += a[0, n) * b; returns the limb carried out of r[n - 1]
+static limb_t addmul_1_generic(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    limb_t rc = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t dop = static_cast<double_limb_t>(a[i]) * b + r[i] + rc;
+        r[i] = dop % LIMB_BASE;
+        rc = dop >> LIMB_BITS;
+    }
+    return rc;
+}
+
+// r[0, n) -= a[0, n) * b; returns the limb borrowed out of r[n - 1]
+static limb_t submul_1_generic(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t dop = static_cast<double_limb_t>(a[i]) * b + borrow;
+        limb_t lo = static_cast<limb_t>(dop);
+        borrow = static_cast<limb_t>(dop >> LIMB_BITS) + (r[i] < lo);
+        r[i] -= lo;
+    }
+    return borrow;
+}
+
+#ifdef BIGINT_ADX
+static bool cpu_has_adx() {
+    unsigned eax, ebx, ecx, edx;
+    return __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_BMI2) && (ebx & bit_ADX);
+}
+
+// false until the initializers of this file have run, arithmetic in earlier
+// static initializers takes the portable loops
+static const bool HAS_ADX = cpu_has_adx();
+
+// The assembly kernels take k > 0 blocks of four limbs and a carry in c, the
+// dispatching functions run the n % 4 lowest limbs through the portable loops.
+// add and sub need only the baseline instruction set and one carry chain, the
+// dec that counts the blocks leaves CF alone
+
+// the BIGINT_NASM build takes add, sub and mul_1 from asm/long_arith.asm instead
+#ifndef BIGINT_NASM
+// r[0, 4k) = a[0, 4k) + b[0, 4k) + c; returns the carry
+static limb_t add_n_asm(limb_t *r, limb_t const *a, limb_t const *b, size_t k, limb_t c) {
+    __asm__ volatile(
+        "neg %[c]\n\t"
+        "1:\n\t"
+        "mov (%[a]), %%r8\n\t"
+        "mov 8(%[a]), %%r9\n\t"
+        "mov 16(%[a]), %%r10\n\t"
+        "mov 24(%[a]), %%r11\n\t"
+        "adc (%[b]), %%r8\n\t"
+        "adc 8(%[b]), %%r9\n\t"
+        "adc 16(%[b]), %%r10\n\t"
+        "adc 24(%[b]), %%r11\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "mov %%r9, 8(%[r])\n\t"
+        "mov %%r10, 16(%[r])\n\t"
+        "mov %%r11, 24(%[r])\n\t"
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[b]), %[b]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "dec %[k]\n\t"
+        "jnz 1b\n\t"
+        "sbb %[c], %[c]\n\t"
+        "neg %[c]"
+        : [r] "+r"(r), [a] "+r"(a), [b] "+r"(b), [k] "+r"(k), [c] "+r"(c)
+        :
+        : "r8", "r9", "r10", "r11", "cc", "memory");
+    return c;
+}
+
+// r[0, 4k) = a[0, 4k) - b[0, 4k) - c; returns the borrow
+static limb_t sub_n_asm(limb_t *r, limb_t const *a, limb_t const *b, size_t k, limb_t c) {
+    __asm__ volatile(
+        "neg %[c]\n\t"
+        "1:\n\t"
+        "mov (%[a]), %%r8\n\t"
+        "mov 8(%[a]), %%r9\n\t"
+        "mov 16(%[a]), %%r10\n\t"
+        "mov 24(%[a]), %%r11\n\t"
+        "sbb (%[b]), %%r8\n\t"
+        "sbb 8(%[b]), %%r9\n\t"
+        "sbb 16(%[b]), %%r10\n\t"
+        "sbb 24(%[b]), %%r11\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "mov %%r9, 8(%[r])\n\t"
+        "mov %%r10, 16(%[r])\n\t"
+        "mov %%r11, 24(%[r])\n\t"
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[b]), %[b]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "dec %[k]\n\t"
+        "jnz 1b\n\t"
+        "sbb %[c], %[c]\n\t"
+        "neg %[c]"
+        : [r] "+r"(r), [a] "+r"(a), [b] "+r"(b), [k] "+r"(k), [c] "+r"(c)
+        :
+        : "r8", "r9", "r10", "r11", "cc", "memory");
+    return c;
+}
+
+// r[0, 4k) = a[0, 4k) * b + c; returns the high limb. MULX leaves the flags
+// alone, so the high limbs are added to the next low limbs in one ADCX chain
+static limb_t mul_1_adx(limb_t *r, limb_t const *a, size_t k, limb_t b, limb_t c) {
+    __asm__ volatile(
+        "xor %%r8d, %%r8d\n\t"
+        "1:\n\t"
+        "mulx (%[a]), %%r8, %%r9\n\t"
+        "adcx %[c], %%r8\n\t"
+        "mulx 8(%[a]), %%r10, %[c]\n\t"
+        "adcx %%r9, %%r10\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "mov %%r10, 8(%[r])\n\t"
+        "mulx 16(%[a]), %%r8, %%r9\n\t"
+        "adcx %[c], %%r8\n\t"
+        "mulx 24(%[a]), %%r10, %[c]\n\t"
+        "adcx %%r9, %%r10\n\t"
+        "mov %%r8, 16(%[r])\n\t"
+        "mov %%r10, 24(%[r])\n\t"
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "dec %[k]\n\t"
+        "jnz 1b\n\t"
+        "adc $0, %[c]"
+        : [r] "+r"(r), [a] "+r"(a), [k] "+r"(k), [c] "+r"(c)
+        : "d"(b)
+        : "r8", "r9", "r10", "cc", "memory");
+    return c;
+}
+#endif
+
+// r[0, 4k) += a[0, 4k) * b + c; returns the carried limb. The high limbs go
+// into the ADCX chain and r into the ADOX chain, so the two carries run side by
+// side. dec would clobber OF, the blocks are counted in rcx with jrcxz instead
+static limb_t addmul_1_adx(limb_t *r, limb_t const *a, size_t k, limb_t b, limb_t c) {
+    __asm__ volatile(
+        "xor %%r8d, %%r8d\n\t"
+        "1:\n\t"
+        "mulx (%[a]), %%r8, %%r9\n\t"
+        "adcx %[c], %%r8\n\t"
+        "adox (%[r]), %%r8\n\t"
+        "mulx 8(%[a]), %%r10, %[c]\n\t"
+        "adcx %%r9, %%r10\n\t"
+        "adox 8(%[r]), %%r10\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "mov %%r10, 8(%[r])\n\t"
+        "mulx 16(%[a]), %%r8, %%r9\n\t"
+        "adcx %[c], %%r8\n\t"
+        "adox 16(%[r]), %%r8\n\t"
+        "mulx 24(%[a]), %%r10, %[c]\n\t"
+        "adcx %%r9, %%r10\n\t"
+        "adox 24(%[r]), %%r10\n\t"
+        "mov %%r8, 16(%[r])\n\t"
+        "mov %%r10, 24(%[r])\n\t"
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "lea -1(%[k]), %[k]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "mov $0, %%r8d\n\t"
+        "adcx %%r8, %[c]\n\t"
+        "adox %%r8, %[c]"
+        : [r] "+r"(r), [a] "+r"(a), [k] "+c"(k), [c] "+r"(c)
+        : "d"(b)
+        : "r8", "r9", "r10", "cc", "memory");
+    return c;
+}
+
+// r[0, 4k) -= a[0, 4k) * b + c; returns the borrowed limb. r - x is ~(~r + x),
+// so this is addmul_1_adx on the complemented limbs of r, and NOT leaves the
+// flags alone
+static limb_t submul_1_adx(limb_t *r, limb_t const *a, size_t k, limb_t b, limb_t c) {
+    __asm__ volatile(
+        "xor %%r8d, %%r8d\n\t"
+        "1:\n\t"
+        "mov (%[r]), %%r11\n\t"
+        "not %%r11\n\t"
+        "mulx (%[a]), %%r8, %%r9\n\t"
+        "adcx %[c], %%r8\n\t"
+        "adox %%r11, %%r8\n\t"
+        "mov 8(%[r]), %%r11\n\t"
+        "not %%r11\n\t"
+        "mulx 8(%[a]), %%r10, %[c]\n\t"
+        "adcx %%r9, %%r10\n\t"
+        "adox %%r11, %%r10\n\t"
+        "not %%r8\n\t"
+        "not %%r10\n\t"
+        "mov %%r8, (%[r])\n\t"
+        "mov %%r10, 8(%[r])\n\t"
+        "mov 16(%[r]), %%r11\n\t"
+        "not %%r11\n\t"
+        "mulx 16(%[a]), %%r8, %%r9\n\t"
+        "adcx %[c], %%r8\n\t"
+        "adox %%r11, %%r8\n\t"
+        "mov 24(%[r]), %%r11\n\t"
+        "not %%r11\n\t"
+        "mulx 24(%[a]), %%r10, %[c]\n\t"
+        "adcx %%r9, %%r10\n\t"
+        "adox %%r11, %%r10\n\t"
+        "not %%r8\n\t"
+        "not %%r10\n\t"
+        "mov %%r8, 16(%[r])\n\t"
+        "mov %%r10, 24(%[r])\n\t"
+        "lea 32(%[a]), %[a]\n\t"
+        "lea 32(%[r]), %[r]\n\t"
+        "lea -1(%[k]), %[k]\n\t"
+        "jrcxz 2f\n\t"
+        "jmp 1b\n\t"
+        "2:\n\t"
+        "mov $0, %%r8d\n\t"
+        "adcx %%r8, %[c]\n\t"
+        "adox %%r8, %[c]"
+        : [r] "+r"(r), [a] "+r"(a), [k] "+c"(k), [c] "+r"(c)
+        : "d"(b)
+        : "r8", "r9", "r10", "r11", "cc", "memory");
+    return c;
+}
+#endif
+
+// r[0, n) = a[0, n) + b[0, m), m <= n; returns the carry out of r[n - 1]
+limb_t add(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m) {
+#if defined(BIGINT_NASM)
+    if (m > 0) {
+        limb_t c = add_long_long(r, a, b, m);
+        return m == n ? c : add_generic(r + m, a + m, n - m, &c, 1);
+    }
+#elif defined(BIGINT_ADX)
+    if (m >= 4) {
+        size_t k = m % 4;
+        limb_t c = add_n_asm(r + k, a + k, b + k, m / 4, add_generic(r, a, k, b, k));
+        return m == n ? c : add_generic(r + m, a + m, n - m, &c, 1);
+    }
+#endif
+    return add_generic(r, a, n, b, m);
+}
+
+// r[0, n) = a[0, n) - b[0, m), m <= n; returns the borrow out of r[n - 1]
+limb_t sub(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m) {
+#if defined(BIGINT_NASM)
+    if (m > 0) {
+        limb_t c = sub_long_long(r, a, b, m);
+        return m == n ? c : sub_generic(r + m, a + m, n - m, &c, 1);
+    }
+#elif defined(BIGINT_ADX)
+    if (m >= 4) {
+        size_t k = m % 4;
+        limb_t c = sub_n_asm(r + k, a + k, b + k, m / 4, sub_generic(r, a, k, b, k));
+        return m == n ? c : sub_generic(r + m, a + m, n - m, &c, 1);
+    }
+#endif
+    return sub_generic(r, a, n, b, m);
+}
+
+limb_t add_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    return add(r, a, n, b, n);
+}
+
+limb_t sub_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n) {
+    return sub(r, a, n, b, n);
+}
+
+// r[0, n) = a[0, n) * b; returns the high limb of the product
+limb_t mul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+#if defined(BIGINT_NASM)
+    if (n > 0) {
+        return mul_long_short(r, a, n, b);
+    }
+#elif defined(BIGINT_ADX)
+    if (HAS_ADX && n >= 4) {
+        size_t k = n % 4;
+        return mul_1_adx(r + k, a + k, n / 4, b, mul_1_generic(r, a, k, b));
+    }
+#endif
+    return mul_1_generic(r, a, n, b);
+}
+
+// r[0, n) += a[0, n) * b; returns the limb carried out of r[n - 1]
+limb_t addmul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+#ifdef BIGINT_ADX
+    if (HAS_ADX && n >= 4) {
+        size_t k = n % 4;
+        return addmul_1_adx(r + k, a + k, n / 4, b, addmul_1_generic(r, a, k, b));
+    }
+#endif
+    return addmul_1_generic(r, a, n, b);
+}
+
+// r[0, n) -= a[0, n) * b; returns the limb borrowed out of r[n - 1]
+limb_t submul_1(limb_t *r, limb_t const *a, size_t n, limb_t b) {
+#ifdef BIGINT_ADX
+    if (HAS_ADX && n >= 4) {
+        size_t k = n % 4;
+        return submul_1_adx(r + k, a + k, n / 4, b, submul_1_generic(r, a, k, b));
+    }
+#endif
+    return submul_1_generic(r, a, n, b);
+}
+
+// r[0, n + m) = a[0, n) * b[0, m), one row of n limbs per limb of b
+void mul_basecase(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m) {
+#ifdef BIGINT_NASM
+    if (n > 0 && m > 0) {
+        mul_long_long(r, a, n, b, m);
+        return;
+    }
+#endif
+    std::fill(r, r + n + m, 0);
+    for (size_t j = 0; j < m; j++) {
+        r[n + j] = addmul_1(r + j, a, n, b[j]);
+    }
+}
+
+// r[0, 2n) = a[0, n)^2, every cross product is computed once and doubled
+void sqr_basecase(limb_t *r, limb_t const *a, size_t n) {
+    std::fill(r, r + 2 * n, 0);
+    for (size_t i = 0; i < n; i++) {
+        r[n + i] = addmul_1(r + 2 * i + 1, a + i + 1, n - i - 1, a[i]);
+    }
+    limb_t top = 0;
+    for (size_t i = 0; i < 2 * n; i++) {
+        limb_t limb = r[i];
+        r[i] = (limb << 1u) | top;
+        top = limb >> (LIMB_BITS - 1);
+    }
+    double_limb_t rc = 0;
+    for (size_t i = 0; i < n; i++) {
+        double_limb_t sq = static_cast<double_limb_t>(a[i]) * a[i];
+        rc += static_cast<double_limb_t>(r[2 * i]) + sq % LIMB_BASE;
+        r[2 * i] = rc % LIMB_BASE;
+        rc >>= LIMB_BITS;
+        rc += static_cast<double_limb_t>(r[2 * i + 1]) + (sq >> LIMB_BITS);
+        r[2 * i + 1] = rc % LIMB_BASE;
+        rc >>= LIMB_BITS;
+    }
+}
+
+// r[0, n) = -r[0, n) in two's complement
+static void negate_limbs(limb_t *r, size_t n) {
+    double_limb_t rc = 1;
+    for (size_t i = 0; i < n; i++) {
+        rc += static_cast<limb_t>(~r[i]);
+        r[i] = rc % LIMB_BASE;
+        rc >>= LIMB_BITS;
+    }
+}
+
+// r[0, n) >>= 1 keeping the sign of the two's complement value
+static void shr1_signed(limb_t *r, size_t n) {
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[i] = (r[i] >> 1u) | (r[i + 1] << (LIMB_BITS - 1));
+    }
+    r[n - 1] = (r[n - 1] >> 1u) | (r[n - 1] & SIGN_BIT);
+}
+
+// r[0, n) = a[0, n) << shift for 0 < shift < LIMB_BITS; returns the bits shifted
+// out of a[n - 1]. Runs from the top down, so r may be a or overlap it from above
+limb_t lshift(limb_t *r, limb_t const *a, size_t n, unsigned shift) {
+    limb_t out = a[n - 1] >> (LIMB_BITS - shift);
+    for (size_t i = n - 1; i > 0; i--) {
+        r[i] = (a[i] << shift) | (a[i - 1] >> (LIMB_BITS - shift));
+    }
+    r[0] = a[0] << shift;
+    return out;
+}
+
+// r[0, n) = a[0, n) >> shift for 0 < shift < LIMB_BITS; returns the bits shifted
+// out of a[0]. Runs from the bottom up, so r may be a or overlap it from below
+limb_t rshift(limb_t *r, limb_t const *a, size_t n, unsigned shift) {
+    limb_t out = a[0] << (LIMB_BITS - shift);
+    for (size_t i = 0; i + 1 < n; i++) {
+        r[i] = (a[i] >> shift) | (a[i + 1] << (LIMB_BITS - shift));
+    }
+    r[n - 1] = a[n - 1] >> shift;
+    return out;
+}
+
+// r[0, n) /= 3, the two's complement value must be divisible by 3
+static void divexact_by3(limb_t *r, size_t n) {
+    static const limb_t INV3 = LIMB_MAX / 3 * 2 + 1;
+    limb_t borrow = 0;
+    for (size_t i = 0; i < n; i++) {
+        limb_t s = r[i] - borrow;
+        borrow = r[i] < borrow;
+        r[i] = s * INV3;
+        borrow += (static_cast<double_limb_t>(r[i]) * 3) >> LIMB_BITS;
+    }
+}
+
+// upper bound of the scratch used by mul for operands of at most n limbs
+size_t mul_scratch_size(size_t n) {
+    if (n < KARATSUBA_THRESHOLD) {
+        return 0;
+    }
+    size_t h = (n + 1) / 2;
+    size_t size = 4 * h + 4 + mul_scratch_size(h + 1);
+    if (n >= TOOM3_THRESHOLD) {
+        size_t k = (n + 2) / 3;
+        size = std::max(size, 10 * k + 10 + mul_scratch_size(k + 1));
+    }
+    return size;
+}
+
+// r[0, k + 1) = |x0 + x1 + x2| or |x0 - x1 + x2| computed from t = x0 + x2,
+// returns true if the value is negative
+static bool toom3_eval_1(limb_t *r, limb_t const *t, limb_t const *x1, size_t len1, size_t k, bool minus) {
+    if (!minus) {
+        r[k] = t[k] + add(r, t, k, x1, len1);
+        return false;
+    }
+    size_t i = k + 1;
+    for (; i > len1 && t[i - 1] == 0; i--);
+    bool negative = false;
+    if (i <= len1) {
+        for (; i > 0 && t[i - 1] == x1[i - 1]; i--);
+        negative = i > 0 && t[i - 1] < x1[i - 1];
+    }
+    if (negative) {
+        sub(r, x1, len1, t, len1);
+        std::fill(r + len1, r + k + 1, 0);
+    } else {
+        sub(r, t, k + 1, x1, len1);
+    }
+    return negative;
+}
+
+// r[0, k + 1) = x0 + 2 * x1 + 4 * x2
+static void toom3_eval_2(limb_t *r, limb_t const *x0, limb_t const *x1, size_t len1,
+                         limb_t const *x2, size_t len2, size_t k) {
+    double_limb_t rc = 0;
+    for (size_t i = 0; i <= k; i++) {
+        double_limb_t v0 = i < k ? x0[i] : 0, v1 = i < len1 ? x1[i] : 0, v2 = i < len2 ? x2[i] : 0;
+        rc += v0 + (v1 << 1u) + (v2 << 2u);
+        r[i] = rc % LIMB_BASE;
+        rc >>= LIMB_BITS;
+    }
+}
+
+// Toom-3 with evaluation points 0, 1, -1, 2, infinity; requires 2k < m <= n <= 3k.
+// When a and b are the same number b is not evaluated and the five products are squares
+static void mul_toom3(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m, size_t k,
+                      limb_t *scratch) {
+    size_t len = 2 * k + 2;
+    bool square = a == b && n == m;
+    limb_t *ta = scratch, *tb = ta + k + 1, *ea = tb + k + 1, *eb = square ? ea : ea + k + 1;
+    limb_t *v1 = eb + k + 1, *vm1 = v1 + len, *v2 = vm1 + len, *next = v2 + len;
+    limb_t const *a1 = a + k, *a2 = a + 2 * k, *b1 = b + k, *b2 = b + 2 * k;
+    size_t na2 = n - 2 * k, nb2 = m - 2 * k, vinf_len = n + m - 4 * k;
+    limb_t *vinf = r + 4 * k;
+
+    mul(r, a, k, b, k, next);
+    mul(vinf, a2, na2, b2, nb2, next);
+    std::fill(r + 2 * k, r + 4 * k, 0);
+
+    ta[k] = add(ta, a, k, a2, na2);
+    tb[k] = add(tb, b, k, b2, nb2);
+    toom3_eval_1(ea, ta, a1, k, k, false);
+    if (!square) {
+        toom3_eval_1(eb, tb, b1, k, k, false);
+    }
+    mul(v1, ea, k + 1, eb, k + 1, next);
+    bool negative = toom3_eval_1(ea, ta, a1, k, k, true);
+    if (!square) {
+        negative ^= toom3_eval_1(eb, tb, b1, k, k, true);
+    }
+    mul(vm1, ea, k + 1, eb, k + 1, next);
+    if (negative && !square) {
+        negate_limbs(vm1, len);
+    }
+    toom3_eval_2(ea, a, a1, k, a2, na2, k);
+    if (!square) {
+        toom3_eval_2(eb, b, b1, k, b2, nb2, k);
+    }
+    mul(v2, ea, k + 1, eb, k + 1, next);
+
+    // interpolation in two's complement modulo B^len, vm1, v1 and v2 become
+    // the coefficients of B^k, B^2k and B^3k
+    sub(v2, v2, len, vm1, len);
+    divexact_by3(v2, len);
+    sub(vm1, v1, len, vm1, len);
+    shr1_signed(vm1, len);
+    sub(v1, v1, len, r, 2 * k);
+    sub(v2, v2, len, v1, len);
+    shr1_signed(v2, len);
+    sub(v1, v1, len, vm1, len);
+    sub(v1, v1, len, vinf, vinf_len);
+    sub(v2, v2, len, vinf, vinf_len);
+    sub(v2, v2, len, vinf, vinf_len);
+    sub(vm1, vm1, len, v2, len);
+
+    add(r + k, r + k, n + m - k, vm1, std::min(len, n + m - k));
+    add(r + 2 * k, r + 2 * k, n + m - 2 * k, v1, std::min(len, n + m - 2 * k));
+    add(r + 3 * k, r + 3 * k, n + m - 3 * k, v2, std::min(len, n + m - 3 * k));
+}
+
+__extension__ typedef unsigned __int128 uint128_t;
+
+// arithmetic modulo a prime p < 2^62, residues are kept in Montgomery form x * 2^64 mod p
+struct ntt_prime {
+    ntt_prime(uint64_t p_, uint64_t generator) : p(p_) {
+        uint64_t inv = p;
+        for (size_t i = 0; i < 5; i++) {
+            inv *= 2 - p * inv;
+        }
+        p_inv = -inv;
+        uint64_t r1 = static_cast<uint64_t>((static_cast<uint128_t>(1) << 64u) % p);
+        r2 = static_cast<uint64_t>(static_cast<uint128_t>(r1) * r1 % p);
+        one = r1;
+        g = to_mont(generator);
+    }
+
+    uint64_t reduce(uint128_t t) const {
+        uint64_t q = static_cast<uint64_t>(t) * p_inv;
+        uint64_t res = (t + static_cast<uint128_t>(q) * p) >> 64u;
+        return res >= p ? res - p : res;
+    }
+
+    uint64_t mul(uint64_t a, uint64_t b) const {
+        return reduce(static_cast<uint128_t>(a) * b);
+    }
+
+    uint64_t add(uint64_t a, uint64_t b) const {
+        uint64_t res = a + b;
+        return res >= p ? res - p : res;
+    }
+
+    uint64_t sub(uint64_t a, uint64_t b) const {
+        return a >= b ? a - b : a + p - b;
+    }
+
+    uint64_t pow(uint64_t a, uint64_t e) const {
+        uint64_t res = one;
+        for (; e; e >>= 1u) {
+            if (e & 1u) {
+                res = mul(res, a);
+            }
+            a = mul(a, a);
+        }
+        return res;
+    }
+
+    // any 64-bit value, not only residues, can be converted
+    uint64_t to_mont(uint64_t a) const {
+        return mul(a, r2);
+    }
+
+    uint64_t from_mont(uint64_t a) const {
+        return reduce(a);
+    }
+
+    // w[len + j] = root^(j * n / 2len) for every level len of a transform of length n
+    void twiddles(std::vector<uint64_t> &w, size_t n, bool inverse) const {
+        uint64_t root = pow(g, (p - 1) / n);
+        if (inverse) {
+            root = pow(root, n - 1);
+        }
+        w.resize(std::max<size_t>(n, 2));
+        size_t half = n / 2;
+        w[half] = one;
+        for (size_t j = 1; j < half; j++) {
+            w[half + j] = mul(w[half + j - 1], root);
+        }
+        for (size_t len = half / 2; len > 0; len /= 2) {
+            for (size_t j = 0; j < len; j++) {
+                w[len + j] = w[2 * len + 2 * j];
+            }
+        }
+    }
+
+    // decimation in frequency, the result is in bit-reversed order
+    void forward(uint64_t *a, size_t n, std::vector<uint64_t> const &w) const {
+        for (size_t len = n / 2; len > 0; len /= 2) {
+            for (size_t i = 0; i < n; i += 2 * len) {
+                for (size_t j = 0; j < len; j++) {
+                    uint64_t u = a[i + j], v = a[i + j + len];
+                    a[i + j] = add(u, v);
+                    a[i + j + len] = mul(sub(u, v), w[len + j]);
+                }
+            }
+        }
+    }
+
+    // decimation in time from bit-reversed order, the result is not divided by n
+    void inverse(uint64_t *a, size_t n, std::vector<uint64_t> const &w) const {
+        for (size_t len = 1; len < n; len *= 2) {
+            for (size_t i = 0; i < n; i += 2 * len) {
+                for (size_t j = 0; j < len; j++) {
+                    uint64_t u = a[i + j], v = mul(a[i + j + len], w[len + j]);
+                    a[i + j] = add(u, v);
+                    a[i + j + len] = sub(u, v);
+                }
+            }
+        }
+    }
+
+    uint64_t p, p_inv, r2, one, g;
+};
+
+// res[0, n) = cyclic convolution of a[0, na) and b[0, nb) modulo pr.p, n is a power of two;
+// if a and b are the same array only one forward transform is done
+static void ntt_convolution(uint64_t *res, ntt_prime const &pr, uint64_t const *a, size_t na,
+                            uint64_t const *b, size_t nb, size_t n, std::vector<uint64_t> &tmp,
+                            std::vector<uint64_t> &w) {
+    tmp.assign(n, 0);
+    std::fill(res, res + n, 0);
+    for (size_t i = 0; i < na; i++) {
+        res[i] = pr.to_mont(a[i]);
+    }
+    if (a != b || na != nb) {
+        for (size_t i = 0; i < nb; i++) {
+            tmp[i] = pr.to_mont(b[i]);
+        }
+    }
+    pr.twiddles(w, n, false);
+    pr.forward(res, n, w);
+    uint64_t const *other = res;
+    if (a != b || na != nb) {
+        pr.forward(tmp.data(), n, w);
+        other = tmp.data();
+    }
+    uint64_t n_inv = pr.pow(pr.to_mont(n), pr.p - 2);
+    for (size_t i = 0; i < n; i++) {
+        res[i] = pr.mul(pr.mul(res[i], other[i]), n_inv);
+    }
+    pr.twiddles(w, n, true);
+    pr.inverse(res, n, w);
+    for (size_t i = 0; i < n; i++) {
+        res[i] = pr.from_mont(res[i]);
+    }
+}
+
+// r[0, n + m) = a[0, n) * b[0, m); the limbs are packed into 64-bit coefficients,
+// convolved modulo three primes and recombined by the chinese remainder theorem
+static void mul_ntt(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m) {
+    static const ntt_prime primes[3] = {ntt_prime(29ull << 57u | 1u, 3), ntt_prime(69ull << 55u | 1u, 5),
+                                        ntt_prime(27ull << 56u | 1u, 5)};
+    static const size_t LIMBS_PER_WORD = sizeof(uint64_t) / sizeof(limb_t);
+    size_t na = (n + LIMBS_PER_WORD - 1) / LIMBS_PER_WORD, nb = (m + LIMBS_PER_WORD - 1) / LIMBS_PER_WORD, len = 1;
+    while (len < na + nb) {
+        len *= 2;
+    }
+    std::vector<uint64_t> wa(na), wb(nb);
+    for (size_t i = 0; i < n; i++) {
+        wa[i / LIMBS_PER_WORD] |= static_cast<uint64_t>(a[i]) << (LIMB_BITS * (i % LIMBS_PER_WORD));
+    }
+    for (size_t i = 0; i < m; i++) {
+        wb[i / LIMBS_PER_WORD] |= static_cast<uint64_t>(b[i]) << (LIMB_BITS * (i % LIMBS_PER_WORD));
+    }
+    uint64_t const *wb_data = a == b && n == m ? wa.data() : wb.data();
+    std::vector<uint64_t> res(3 * len), tmp, w;
+    for (size_t k = 0; k < 3; k++) {
+        ntt_convolution(res.data() + k * len, primes[k], wa.data(), na, wb_data, nb, len, tmp, w);
+    }
+
+    ntt_prime const &p1 = primes[0], &p2 = primes[1], &p3 = primes[2];
+    uint64_t inv12 = p2.pow(p2.to_mont(p1.p), p2.p - 2);
+    uint64_t p1_mod3 = p3.to_mont(p1.p);
+    uint64_t inv123 = p3.pow(p3.mul(p1_mod3, p3.to_mont(p2.p)), p3.p - 2);
+    uint128_t p12 = static_cast<uint128_t>(p1.p) * p2.p;
+    uint64_t p12_lo = static_cast<uint64_t>(p12), p12_hi = static_cast<uint64_t>(p12 >> 64u);
+    uint128_t carry = 0;
+    for (size_t i = 0; i < n + m; i += LIMBS_PER_WORD) {
+        size_t k = i / LIMBS_PER_WORD;
+        uint64_t x1 = res[k], x2 = res[len + k], x3 = res[2 * len + k];
+        // x = x1 + p1 * y2 + p1 * p2 * y3
+        uint64_t y2 = p2.mul(p2.sub(x2, x1 % p2.p), inv12);
+        uint64_t y3 = p3.sub(p3.sub(x3, x1 % p3.p), p3.mul(y2, p1_mod3));
+        y3 = p3.mul(y3, inv123);
+        uint128_t low = static_cast<uint128_t>(p1.p) * y2 + x1;
+        uint128_t t0 = static_cast<uint128_t>(p12_lo) * y3, t1 = static_cast<uint128_t>(p12_hi) * y3;
+        uint128_t sum = static_cast<uint128_t>(static_cast<uint64_t>(carry)) + static_cast<uint64_t>(low)
+                        + static_cast<uint64_t>(t0);
+        uint64_t word = static_cast<uint64_t>(sum);
+        carry = (sum >> 64u) + (carry >> 64u) + (low >> 64u) + (t0 >> 64u) + t1;
+        for (size_t j = 0; j < LIMBS_PER_WORD && i + j < n + m; j++) {
+            r[i + j] = static_cast<limb_t>(word >> (LIMB_BITS * j));
+        }
+    }
+}
+
+// r[0, n + m) = a[0, n) * b[0, m), n >= m; r must not overlap the operands,
+// scratch must hold at least mul_scratch_size(n) limbs. Passing the same
+// pointer and length for a and b selects the squaring kernels on every tier
+void mul(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m, limb_t *scratch) {
+    bool square = a == b && n == m;
+    if (m < KARATSUBA_THRESHOLD) {
+        if (square) {
+            sqr_basecase(r, a, n);
+        } else {
+            mul_basecase(r, a, n, b, m);
+        }
+        return;
+    }
+    if (m >= NTT_THRESHOLD) {
+        mul_ntt(r, a, n, b, m);
+        return;
+    }
+    size_t h = (n + 1) / 2;
+    if (m <= h) {
+        // too unbalanced to split: multiply b by m-limb slices of a
+        limb_t *t = scratch;
+        std::fill(r, r + n + m, 0);
+        for (size_t i = 0; i < n; i += m) {
+            size_t len = std::min(m, n - i);
+            if (len >= m) {
+                mul(t, a + i, len, b, m, t + len + m);
+            } else {
+                mul(t, b, m, a + i, len, t + len + m);
+            }
+            add(r + i, r + i, n + m - i, t, len + m);
+        }
+        return;
+    }
+    if (n >= TOOM3_THRESHOLD) {
+        size_t k = (n + 2) / 3;
+        if (m > 2 * k) {
+            mul_toom3(r, a, n, b, m, k, scratch);
+            return;
+        }
+    }
+    // a = a1 * B^h + a0, b = b1 * B^h + b0
+    // a * b = z2 * B^2h + ((a0 + a1)(b0 + b1) - z2 - z0) * B^h + z0
+    limb_t *sa = scratch, *sb = sa + h + 1, *z1 = sb + h + 1, *next = z1 + 2 * h + 2;
+    mul(r, a, h, b, h, next);
+    mul(r + 2 * h, a + h, n - h, b + h, m - h, next);
+    sa[h] = add(sa, a, h, a + h, n - h);
+    if (square) {
+        sb = sa;
+    } else {
+        sb[h] = add(sb, b, h, b + h, m - h);
+    }
+    mul(z1, sa, h + 1, sb, h + 1, next);
+    sub(z1, z1, 2 * h + 2, r, 2 * h);
+    sub(z1, z1, 2 * h + 2, r + 2 * h, n + m - 2 * h);
+    size_t len = std::min(2 * h + 2, n + m - h);
+    add(r + h, r + h, n + m - h, z1, len);
+}
+
+// sign of a[0, n) - b[0, n)
+int cmp(limb_t const *a, limb_t const *b, size_t n) {
+    for (size_t i = n; i > 0; i--) {
+        if (a[i - 1] != b[i - 1]) {
+            return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+// r[0, n) -= 1; returns the borrow
+static limb_t decrement_limbs(limb_t *r, size_t n) {
+    static const limb_t ONE = 1;
+    return sub(r, r, n, &ONE, 1);
+}
+
+static size_t inv_scratch_size(size_t n);
+
+// upper bound of the scratch used by divrem for divisors of at most n limbs
+size_t div_scratch_size(size_t n) {
+    size_t size = n + 1 + mul_scratch_size(n);
+    if (n >= DIV_NEWTON_THRESHOLD) {
+        size = n + 1 + std::max({size, inv_scratch_size(n), 4 * n + 4 + mul_scratch_size(n + 1)});
+    }
+    return size;
+}
+
+// upper bound of the scratch used by invert_limbs for n limbs
+static size_t inv_scratch_size(size_t n) {
+    if (n < DIV_NEWTON_THRESHOLD) {
+        return 2 * n + 1 + div_scratch_size(n);
+    }
+    size_t h = n / 2 + 1;
+    return h + 1 + std::max(inv_scratch_size(h), 4 * n + 4 + mul_scratch_size(n + 1));
+}
+
+// floor((B^3 - 1) / (d1 * B + d0)) - B for d1 with its top bit set, the
+// reciprocal of Moller and Granlund that turns 3-by-2 divisions into products
+static limb_t invert_3by2(limb_t d1, limb_t d0) {
+    limb_t v = static_cast<limb_t>(((static_cast<double_limb_t>(~d1) << LIMB_BITS) | LIMB_MAX) / d1);
+    limb_t p = d1 * v + d0;
+    if (p < d0) {
+        v--;
+        if (p >= d1) {
+            v--;
+            p -= d1;
+        }
+        p -= d1;
+    }
+    double_limb_t t = static_cast<double_limb_t>(d0) * v;
+    limb_t t1 = static_cast<limb_t>(t >> LIMB_BITS), t0 = static_cast<limb_t>(t);
+    p += t1;
+    if (p < t1) {
+        v--;
+        if (p > d1 || (p == d1 && t0 >= d0)) {
+            v--;
+        }
+    }
+    return v;
+}
+
+// floor((n2 * B^2 + n1 * B + n0) / (d1 * B + d0)) for n2 * B + n1 below d1 * B + d0,
+// with v = invert_3by2(d1, d0)
+static limb_t div_3by2(limb_t n2, limb_t n1, limb_t n0, limb_t d1, limb_t d0, limb_t v) {
+    double_limb_t qq = static_cast<double_limb_t>(n2) * v + ((static_cast<double_limb_t>(n2) << LIMB_BITS) | n1);
+    limb_t q = static_cast<limb_t>(qq >> LIMB_BITS), q0 = static_cast<limb_t>(qq);
+    // the remainder of the candidate q + 1 modulo B^2
+    double_limb_t d = (static_cast<double_limb_t>(d1) << LIMB_BITS) | d0;
+    double_limb_t r = ((static_cast<double_limb_t>(n1 - d1 * q) << LIMB_BITS) | n0) - d -
+                      static_cast<double_limb_t>(d0) * q;
+    q++;
+    if (static_cast<limb_t>(r >> LIMB_BITS) >= q0) {
+        q--;
+        r += d;
+    }
+    if (r >= d) {
+        q++;
+    }
+    return q;
+}
+
+// q[0, nn - dn) = np[0, nn) / dp[0, dn), the remainder replaces np[0, dn).
+// dn must be at least 2 and the top bit of dp[dn - 1] set. Returns the
+// quotient limb at q[nn - dn], which is 0 or 1
+static limb_t divrem_basecase(limb_t *q, limb_t *np, size_t nn, limb_t const *dp, size_t dn) {
+    assert(dn >= 2);
+    limb_t qh = cmp(np + nn - dn, dp, dn) >= 0;
+    if (qh) {
+        sub(np + nn - dn, np + nn - dn, dn, dp, dn);
+    }
+    limb_t d1 = dp[dn - 1], d0 = dp[dn - 2], v = invert_3by2(d1, d0);
+    for (size_t i = nn - dn; i > 0; i--) {
+        // the window w[0, dn + 1) is below dp * B, so the quotient of its top three
+        // limbs by the top two of dp exceeds the digit by at most 1, and rarely does;
+        // when they equal the top of dp the digit is B - 1
+        limb_t *w = np + i - 1;
+        limb_t qt = LIMB_MAX;
+        if (w[dn] != d1 || w[dn - 1] != d0) {
+            qt = div_3by2(w[dn], w[dn - 1], w[dn - 2], d1, d0, v);
+        }
+        limb_t borrow = submul_1(w, dp, dn, qt);
+        if (w[dn] < borrow) {
+            qt--;
+            add(w, w, dn, dp, dn);
+        }
+        w[dn] = 0;
+        q[i - 1] = qt;
+    }
+    return qh;
+}
+
+// q[0, n) = np[0, 2n) / dp[0, n) by Burnikel-Ziegler recursion: the high half of the
+// quotient is found from the high half of the divisor, then corrected by one
+// n-limb product, and the same for the low half. Same contract as divrem_basecase,
+// scratch must hold div_scratch_size(n) limbs
+static limb_t divrem_dc(limb_t *q, limb_t *np, limb_t const *dp, size_t n, limb_t *scratch) {
+    size_t lo = n / 2, hi = n - lo;
+    limb_t qh, ql, cy;
+    if (hi < DIV_DC_THRESHOLD) {
+        qh = divrem_basecase(q + lo, np + 2 * lo, 2 * hi, dp + lo, hi);
+    } else {
+        qh = divrem_dc(q + lo, np + 2 * lo, dp + lo, hi, scratch);
+    }
+    mul(scratch, q + lo, hi, dp, lo, scratch + n);
+    cy = sub(np + lo, np + lo, n, scratch, n);
+    if (qh) {
+        cy += sub(np + n, np + n, lo, dp, lo);
+    }
+    while (cy) {
+        qh -= decrement_limbs(q + lo, hi);
+        cy -= add(np + lo, np + lo, n, dp, n);
+    }
+
+    if (lo < DIV_DC_THRESHOLD) {
+        ql = divrem_basecase(q, np + hi, 2 * lo, dp + hi, lo);
+    } else {
+        ql = divrem_dc(q, np + hi, dp + hi, lo, scratch);
+    }
+    mul(scratch, dp, hi, q, lo, scratch + n);
+    cy = sub(np, np, n, scratch, n);
+    if (ql) {
+        cy += sub(np + lo, np + lo, hi, dp, hi);
+    }
+    while (cy) {
+        decrement_limbs(q, lo);
+        cy -= add(np, np, n, dp, n);
+    }
+    return qh;
+}
+
+// x[0, n + 1) = floor(B^2n / dp[0, n)) - k with 0 <= k <= 3, the top bit of
+// dp[n - 1] must be set; scratch must hold inv_scratch_size(n) limbs
+static void invert_limbs(limb_t *x, limb_t const *dp, size_t n, limb_t *scratch) {
+    if (n < DIV_NEWTON_THRESHOLD) {
+        std::fill(scratch, scratch + 2 * n, 0);
+        scratch[2 * n] = 1;
+        divrem(x, scratch, 2 * n + 1, dp, n, scratch + 2 * n + 1);
+        return;
+    }
+    // xh is the reciprocal of the high h limbs, lowered so that y = xh * B^(n - h)
+    // stays below B^2n / d. One Newton step y + y * (B^2n - d * y) / B^2n never
+    // overshoots and, as 2h >= n + 2, loses at most the truncations
+    static const limb_t SLACK = 5;
+    size_t h = n / 2 + 1;
+    limb_t *xh = scratch, *t = xh + h + 1, *next = t + 2 * n + 2;
+    invert_limbs(xh, dp + n - h, h, t);
+    sub(xh, xh, h + 1, &SLACK, 1);
+    // e = B^(n + h) - d * xh is below B^(n + 1)
+    mul(t, dp, n, xh, h + 1, next);
+    negate_limbs(t, n + 1);
+    size_t en = n + 1;
+    for (; en > 0 && t[en - 1] == 0; en--);
+    std::fill(x, x + n - h, 0);
+    std::copy(xh, xh + h + 1, x + n - h);
+    if (en + h + 1 > 2 * h) {
+        if (en >= h + 1) {
+            mul(next, t, en, xh, h + 1, next + en + h + 1);
+        } else {
+            mul(next, xh, h + 1, t, en, next + en + h + 1);
+        }
+        add(x, x, n + 1, next + 2 * h, en + 1 - h);
+    }
+}
+
+// q[0, n) = np[0, 2n) / dp[0, n) given x = invert_limbs(dp): the high half of the
+// dividend times x is at most a few units below the quotient. Same contract as
+// divrem_basecase, np[n + 1, 2n) is left unspecified, scratch must hold
+// 4n + 4 + mul_scratch_size(n + 1) limbs
+static limb_t divrem_newton(limb_t *q, limb_t *np, limb_t const *dp, size_t n, limb_t const *x, limb_t *scratch) {
+    static const limb_t ONE = 1;
+    limb_t qh = cmp(np + n, dp, n) >= 0;
+    if (qh) {
+        sub(np + n, np + n, n, dp, n);
+    }
+    // the top limb of x is 1 or 2, it is added separately to keep the product n by n
+    limb_t *p = scratch, *t = p + 2 * n + 1, *next = t + n + 1;
+    mul(p, x, n, np + n, n, next);
+    p[2 * n] = 0;
+    t[n] = mul_1(t, np + n, n, x[n]);
+    add(p + n, p + n, n + 1, t, n + 1);
+    std::copy(p + n, p + 2 * n, q);
+    mul(p, q, n, dp, n, next);
+    // the remainder is below B^(n + 1), so its low limbs are enough
+    sub(np, np, n + 1, p, n + 1);
+    while (np[n] != 0 || cmp(np, dp, n) >= 0) {
+        add(q, q, n, &ONE, 1);
+        np[n] -= sub(np, np, n, dp, n);
+    }
+    return qh;
+}
+
+// q[0, nn - dn) = np[0, nn) / dp[0, dn), the remainder replaces np[0, dn).
+// Same contract as divrem_basecase, scratch must hold div_scratch_size(dn) limbs
+limb_t divrem(limb_t *q, limb_t *np, size_t nn, limb_t const *dp, size_t dn, limb_t *scratch) {
+    size_t qn = nn - dn;
+    if (dn < DIV_DC_THRESHOLD || qn < DIV_DC_THRESHOLD) {
+        return divrem_basecase(q, np, nn, dp, dn);
+    }
+    // the top qn0 quotient limbs are divided by the top qn0 limbs of the divisor
+    // and corrected, the rest is split in blocks of dn limbs
+    size_t qn0 = 1 + (qn - 1) % dn;
+    limb_t *qp = q + qn - qn0, *w = np + nn - qn0 - dn;
+    limb_t qh;
+    // huge divisors keep their reciprocal in x[0, dn + 1)
+    limb_t *x = scratch;
+    if (dn >= DIV_NEWTON_THRESHOLD) {
+        scratch += dn + 1;
+    }
+    if (qn0 == 1) {
+        // the 3-by-2 estimate needs two divisor limbs, one limb is divided directly
+        limb_t *t = w + dn - 1, d1 = dp[dn - 1];
+        qh = t[1] >= d1;
+        if (qh) {
+            t[1] -= d1;
+        }
+        double_limb_t top = (static_cast<double_limb_t>(t[1]) << LIMB_BITS) | t[0];
+        qp[0] = static_cast<limb_t>(top / d1);
+        t[0] = static_cast<limb_t>(top % d1);
+        t[1] = 0;
+    } else if (qn0 < DIV_DC_THRESHOLD) {
+        qh = divrem_basecase(qp, w + dn - qn0, 2 * qn0, dp + dn - qn0, qn0);
+    } else if (qn0 >= DIV_NEWTON_THRESHOLD) {
+        invert_limbs(x, dp + dn - qn0, qn0, scratch);
+        qh = divrem_newton(qp, w + dn - qn0, dp + dn - qn0, qn0, x, scratch);
+    } else {
+        qh = divrem_dc(qp, w + dn - qn0, dp + dn - qn0, qn0, scratch);
+    }
+    if (qn0 != dn) {
+        if (qn0 > dn - qn0) {
+            mul(scratch, qp, qn0, dp, dn - qn0, scratch + dn);
+        } else {
+            mul(scratch, dp, dn - qn0, qp, qn0, scratch + dn);
+        }
+        limb_t cy = sub(w, w, dn, scratch, dn);
+        if (qh) {
+            cy += sub(w + qn0, w + qn0, dn - qn0, dp, dn - qn0);
+        }
+        while (cy) {
+            qh -= decrement_limbs(qp, qn0);
+            cy -= add(w, w, dn, dp, dn);
+        }
+    }
+    if (qn == qn0) {
+        return qh;
+    }
+    if (dn < DIV_NEWTON_THRESHOLD) {
+        for (size_t i = qn - qn0; i > 0; i -= dn) {
+            divrem_dc(q + i - dn, np + i - dn, dp, dn, scratch);
+        }
+    } else {
+        invert_limbs(x, dp, dn, scratch);
+        for (size_t i = qn - qn0; i > 0; i -= dn) {
+            divrem_newton(q + i - dn, np + i - dn, dp, dn, x, scratch);
+        }
+    }
+    return qh;
+}
+
+// q[0, n) = a[0, n) / d from the top limb down; returns the remainder
+limb_t divrem_1(limb_t *q, limb_t const *a, size_t n, limb_t d) {
+#ifdef BIGINT_NASM
+    if (n > 0) {
+        return div_long_short(q, a, n, d);
+    }
+#endif
+    limb_t rem = 0;
+    for (size_t i = n; i > 0; i--) {
+        double_limb_t rc = (static_cast<double_limb_t>(rem) << LIMB_BITS) + a[i - 1];
+        q[i - 1] = rc / d;
+        rem = rc % d;
+    }
+    return rem;
+}
+
+// the operations of and_n, ior_n and xor_n on limbs and on SIMD registers of limbs
+struct and_op {
+    limb_t operator()(limb_t a, limb_t b) const {
+        return a & b;
+    }
+#ifdef BIGINT_X86_64
+    __m128i operator()(__m128i a, __m128i b) const {
+        return _mm_and_si128(a, b);
+    }
+
+    __attribute__((target("avx2"))) __m256i operator()(__m256i a, __m256i b) const {
+        return _mm256_and_si256(a, b);
+    }
+#endif
+};
+
+struct or_op {
+    limb_t operator()(limb_t a, limb_t b) const {
+        return a | b;
+    }
+#ifdef BIGINT_X86_64
+    __m128i operator()(__m128i a, __m128i b) const {
+        return _mm_or_si128(a, b);
+    }
+
+    __attribute__((target("avx2"))) __m256i operator()(__m256i a, __m256i b) const {
+        return _mm256_or_si256(a, b);
+    }
+#endif
+};
+
+struct xor_op {
+    limb_t operator()(limb_t a, limb_t b) const {
+        return a ^ b;
+    }
+#ifdef BIGINT_X86_64
+    __m128i operator()(__m128i a, __m128i b) const {
+        return _mm_xor_si128(a, b);
+    }
+
+    __attribute__((target("avx2"))) __m256i operator()(__m256i a, __m256i b) const {
+        return _mm256_xor_si256(a, b);
+    }
+#endif
+};
+
+// r[i] = op(a[i] ^ ma, (b ? b[i] : 0) ^ mb) ^ mr for i in [0, n); the masks are 0 or
+// all ones and complement whole operands, b is null past the end of the shorter one.
+// r may be a or b
+template <typename Op>
+static void bitwise_limbs_generic(limb_t *r, limb_t const *a, limb_t const *b, size_t n,
+                                  limb_t ma, limb_t mb, limb_t mr) {
+    Op op;
+    for (size_t i = 0; i < n; i++) {
+        r[i] = op(a[i] ^ ma, (b ? b[i] : 0) ^ mb) ^ mr;
+    }
+}
+
+#ifdef BIGINT_X86_64
+template <typename Op>
+static void bitwise_limbs_sse2(limb_t *r, limb_t const *a, limb_t const *b, size_t n,
+                               limb_t ma, limb_t mb, limb_t mr) {
+    static const size_t STEP = sizeof(__m128i) / sizeof(limb_t);
+    Op op;
+    __m128i va = _mm_set1_epi8(static_cast<char>(ma)), vb = _mm_set1_epi8(static_cast<char>(mb)),
+            vr = _mm_set1_epi8(static_cast<char>(mr));
+    size_t i = 0;
+    for (; i + STEP <= n; i += STEP) {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(a + i)), va);
+        __m128i y = b ? _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const *>(b + i)), vb) : vb;
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(r + i), _mm_xor_si128(op(x, y), vr));
+    }
+    bitwise_limbs_generic<Op>(r + i, a + i, b ? b + i : b, n - i, ma, mb, mr);
+}
+
+template <typename Op>
+__attribute__((target("avx2"))) static void bitwise_limbs_avx2(limb_t *r, limb_t const *a, limb_t const *b, size_t n,
+                                                               limb_t ma, limb_t mb, limb_t mr) {
+    static const size_t STEP = sizeof(__m256i) / sizeof(limb_t);
+    Op op;
+    __m256i va = _mm256_set1_epi8(static_cast<char>(ma)), vb = _mm256_set1_epi8(static_cast<char>(mb)),
+            vr = _mm256_set1_epi8(static_cast<char>(mr));
+    size_t i = 0;
+    for (; i + STEP <= n; i += STEP) {
+        __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(a + i)), va);
+        __m256i y = b ? _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(b + i)), vb) : vb;
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(r + i), _mm256_xor_si256(op(x, y), vr));
+    }
+    bitwise_limbs_generic<Op>(r + i, a + i, b ? b + i : b, n - i, ma, mb, mr);
+}
+
+// __builtin_cpu_supports needs __builtin_cpu_init before constructors have run
+static bool cpu_has_avx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+static const bool HAS_AVX2 = cpu_has_avx2();
+#endif
+
+template <typename Op>
+static void bitwise_limbs(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr) {
+#ifdef BIGINT_X86_64
+    if (HAS_AVX2) {
+        bitwise_limbs_avx2<Op>(r, a, b, n, ma, mb, mr);
+    } else {
+        bitwise_limbs_sse2<Op>(r, a, b, n, ma, mb, mr);
+    }
+#else
+    bitwise_limbs_generic<Op>(r, a, b, n, ma, mb, mr);
+#endif
+}
+
+void and_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr) {
+    bitwise_limbs<and_op>(r, a, b, n, ma, mb, mr);
+}
+
+void ior_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr) {
+    bitwise_limbs<or_op>(r, a, b, n, ma, mb, mr);
+}
+
+void xor_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr) {
+    bitwise_limbs<xor_op>(r, a, b, n, ma, mb, mr);
+}
+}
@@ -0,0 +1,99 @@
+#ifndef MPN_H
+#define MPN_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Arithmetic on magnitudes stored as arrays of limbs, least significant first.
+// The kernels do not allocate: callers pass every output and scratch buffer, so
+// they run as well on the storage of big_integer as on buffers of their own.
+// The one exception is multiplication of operands of at least 20480 bits, by
+// mul or inside divrem, whose number theoretic transforms keep their own buffers.
+// Carries and borrows are returned as limbs, lengths are counts of limbs and
+// an output may be the same array as an input only where that is stated
+namespace mpn {
+// define BIGINT_LIMB32 to build with 32-bit limbs on targets without a
+// 128-bit integer type
+#ifdef BIGINT_LIMB32
+typedef uint32_t limb_t;
+typedef uint64_t double_limb_t;
+#else
+typedef uint64_t limb_t;
+__extension__ typedef unsigned __int128 double_limb_t;
+#endif
+
+// divisors of at least this many limbs, 2^20 bits unless BIGINT_DIV_NEWTON_THRESHOLD
+// is defined, are divided by multiplying with a Newton reciprocal
+#ifdef BIGINT_DIV_NEWTON_THRESHOLD
+static const size_t DIV_NEWTON_THRESHOLD = BIGINT_DIV_NEWTON_THRESHOLD;
+#else
+static const size_t DIV_NEWTON_THRESHOLD = 1048576 / (sizeof(limb_t) * 8);
+#endif
+
+// r[0, n) = a[0, n) + b[0, n); returns the carry. r may be a or b
+limb_t add_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+// r[0, n) = a[0, n) + b[0, m), m <= n; returns the carry. r may be a or b
+limb_t add(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m);
+
+// r[0, n) = a[0, n) - b[0, n); returns the borrow. r may be a or b
+limb_t sub_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n);
+
+// r[0, n) = a[0, n) - b[0, m), m <= n; returns the borrow. r may be a or b
+limb_t sub(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m);
+
+// r[0, n) = a[0, n) * b; returns the high limb. r may be a
+limb_t mul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+// r[0, n) += a[0, n) * b; returns the carried limb
+limb_t addmul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+// r[0, n) -= a[0, n) * b; returns the borrowed limb
+limb_t submul_1(limb_t *r, limb_t const *a, size_t n, limb_t b);
+
+// r[0, n + m) = a[0, n) * b[0, m) by the schoolbook method, r must not overlap the operands
+void mul_basecase(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m);
+
+// r[0, 2n) = a[0, n)^2 by the schoolbook method, r must not overlap a
+void sqr_basecase(limb_t *r, limb_t const *a, size_t n);
+
+// the number of scratch limbs that mul needs for operands of at most n limbs
+size_t mul_scratch_size(size_t n);
+
+// r[0, n + m) = a[0, n) * b[0, m), n >= m > 0, choosing the algorithm by length.
+// r must not overlap the operands. Passing the same pointer and length for a
+// and b squares
+void mul(limb_t *r, limb_t const *a, size_t n, limb_t const *b, size_t m, limb_t *scratch);
+
+// q[0, n) = a[0, n) / d for d != 0; returns the remainder. q may be a
+limb_t divrem_1(limb_t *q, limb_t const *a, size_t n, limb_t d);
+
+// the number of scratch limbs that divrem needs for divisors of n limbs
+size_t div_scratch_size(size_t n);
+
+// q[0, nn - dn) = np[0, nn) / dp[0, dn) for a divisor of at least two limbs
+// whose top bit is set, nn >= dn; returns the quotient limb q[nn - dn], which
+// is 0 or 1. The remainder replaces np[0, dn)
+limb_t divrem(limb_t *q, limb_t *np, size_t nn, limb_t const *dp, size_t dn, limb_t *scratch);
+
+// r[0, n) = a[0, n) << shift, 0 < shift < the bits in a limb; returns the bits
+// shifted out. Runs from the top down, r may be a or overlap it from above
+limb_t lshift(limb_t *r, limb_t const *a, size_t n, unsigned shift);
+
+// r[0, n) = a[0, n) >> shift, 0 < shift < the bits in a limb; returns the bits
+// shifted out, at the top of the limb. Runs from the bottom up, r may be a or
+// overlap it from below
+limb_t rshift(limb_t *r, limb_t const *a, size_t n, unsigned shift);
+
+// the sign of a[0, n) - b[0, n)
+int cmp(limb_t const *a, limb_t const *b, size_t n);
+
+// r[i] = op(a[i] ^ ma, (b ? b[i] : 0) ^ mb) ^ mr for i in [0, n). The masks are 0
+// or all ones and complement whole operands, b is null past the end of the
+// shorter one. r may be a or b
+void and_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr);
+void ior_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr);
+void xor_n(limb_t *r, limb_t const *a, limb_t const *b, size_t n, limb_t ma, limb_t mb, limb_t mr);
+}
+
+#endif